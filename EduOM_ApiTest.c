@@ -0,0 +1,720 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduOM_ApiTest.c
+ *
+ * Description :
+ *  Regression test of the EduOM interface functions added to the baseline.
+ *  Each case works on a file of its own:
+ *  (1) EduOM_CreateObjects() creates a batch of objects read back one by one.
+ *  (2) EduOM_PinObject() returns the objects in the buffer, and
+ *      EduOM_CheckPinLeaks() counts the pins until they are released.
+ *  (3) EduOM_ScanPageBatch() returns the objects in the order of
+ *      EduOM_ScanNext(), EduOM_NextObject() and EduOM_PrevObject().
+ *  (4) EduOM_InitBulkLoad(), EduOM_NextBulkLoad() and EduOM_FinalBulkLoad()
+ *      load objects read back one by one.
+ *  (5) EduOM_OpenSequentialScan() visits every object, also while an
+ *      object is pinned.
+ *  (6) EduOM_FlushDirtyPages() writes out the pages dirtied by the
+ *      insertions and empties the write-behind queue.
+ *  It replaces EduOM_Test.c in the EduOM_ApiTest executable and prints
+ *  "EduOM_ApiTest passed" when every check holds.
+ *
+ * Exports:
+ *  Four EduOM_Test(Four, Four, Boolean)
+ */
+#include <string.h>
+#include "EduOM_common.h"
+#include "EduOM.h"
+#include "EduOM_Internal.h"
+#include "EduOM_TestModule.h"
+
+
+#define APITEST_NOBJECTS	400	/* maximum # of objects of a case */
+#define APITEST_MAXSIZE		200	/* maximum size of the objects created */
+#define APITEST_NBATCH		300	/* # of objects created by a batch */
+#define APITEST_NPINNED		100	/* # of objects pinned */
+#define APITEST_NPINS		16	/* # of pins held at once */
+#define APITEST_NSCANNED	200	/* # of objects scanned by batches */
+#define APITEST_BATCHMAX	32	/* maximum # of objects of a scan batch */
+#define APITEST_NLOADED		400	/* # of objects of a bulk load */
+#define APITEST_FILLFACTOR	80	/* fill factor of the bulk load */
+#define APITEST_NSEQSCANNED	300	/* # of objects of a sequential scan */
+#define APITEST_NFLUSHED	200	/* # of objects whose pages are flushed */
+
+/* Macro: APITEST_LENGTH(n)
+ * Description: length of the object 'n'
+ */
+#define APITEST_LENGTH(n)	(20 + ((n) * 37) % (APITEST_MAXSIZE - 20))
+
+/* Macro: APITEST_CHECK(cond, msg)
+ * Description: print 'msg' and fail the test if 'cond' does not hold
+ */
+#define APITEST_CHECK(cond, msg) \
+BEGIN_MACRO \
+    if (!(cond)) { \
+        printf("FAIL : %s (%s:%d)\n", (msg), __FILE__, __LINE__); \
+        return(eBADPARAMETER_OM); \
+    } \
+END_MACRO
+
+
+static ObjectID apiOid[APITEST_NOBJECTS];	/* objects of the case */
+static ObjectID apiWalk[APITEST_NOBJECTS];	/* objects in the order of a scan */
+static char     apiData[APITEST_NOBJECTS][APITEST_MAXSIZE];	/* contents of the objects */
+
+
+
+/*@================================
+ * apitest_Fill()
+ *================================*/
+/*
+ * Function: void apitest_Fill(Four)
+ *
+ * Description :
+ *  Fill apiData[] with the contents of the first 'nObjects' objects.
+ */
+static void apitest_Fill(
+    Four		nObjects)	/* IN # of objects */
+{
+    Four		n;		/* number of the object */
+    Four		i;		/* index */
+
+
+    for (n = 0; n < nObjects; n++)
+        for (i = 0; i < APITEST_LENGTH(n); i++)
+            apiData[n][i] = 'a' + (n + i) % 26;
+
+} /* apitest_Fill() */
+
+
+
+/*@================================
+ * apitest_NewFile()
+ *================================*/
+/*
+ * Function: Four apitest_NewFile(Four, ObjectID*)
+ *
+ * Description :
+ *  Create a data file for a case.
+ *
+ * Returns:
+ *  error code
+ */
+static Four apitest_NewFile(
+    Four		volId,		/* IN volume of the file */
+    ObjectID		*catalogEntry)	/* OUT catalog object of the file */
+{
+    Four		e;		/* error number */
+    FileID		fid;		/* file identifier */
+
+
+    e = SM_CreateFile(volId, &fid, FALSE, NULL);
+    if (e < eNOERROR) ERR(e);
+
+    e = sm_GetCatalogEntryFromDataFileId(ARRAYINDEX, &fid, catalogEntry);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* apitest_NewFile() */
+
+
+
+/*@================================
+ * apitest_CheckFile()
+ *================================*/
+/*
+ * Function: Four apitest_CheckFile(ObjectID*, Four)
+ *
+ * Description :
+ *  Read the first 'nObjects' objects of apiOid[] and count the objects of
+ *  the file with EduOM_NextObject(); each must hold its contents and the
+ *  file must hold no other object.
+ *
+ * Returns:
+ *  error code
+ */
+static Four apitest_CheckFile(
+    ObjectID		*catObjForFile,	/* IN file to check */
+    Four		nObjects)	/* IN # of objects of the file */
+{
+    Four		e;		/* error number */
+    Four		n;		/* number of the object */
+    Four		nFound;		/* # of objects walked */
+    ObjectID		oid;		/* object walked */
+    char		buf[APITEST_MAXSIZE];	/* contents read */
+
+
+    for (n = 0; n < nObjects; n++) {
+        e = EduOM_ReadObject(&apiOid[n], 0, REMAINDER, buf);
+        if (e < eNOERROR) ERR(e);
+
+        APITEST_CHECK(e == APITEST_LENGTH(n) && memcmp(buf, apiData[n], APITEST_LENGTH(n)) == 0,
+                      "object read through its ObjectID");
+    }
+
+    nFound = 0;
+    e = EduOM_NextObject(catObjForFile, NULL, &oid, NULL);
+    while (e == eNOERROR) {
+        nFound++;
+        e = EduOM_NextObject(catObjForFile, &oid, &oid, NULL);
+    }
+    if (e < eNOERROR) ERR(e);
+
+    APITEST_CHECK(nFound == nObjects, "NextObject visits every object once");
+
+    return(eNOERROR);
+
+} /* apitest_CheckFile() */
+
+
+
+/*@================================
+ * apitest_CreateObjects()
+ *================================*/
+/*
+ * Function: Four apitest_CreateObjects(Four)
+ *
+ * Description :
+ *  Create APITEST_NBATCH objects of various lengths by one call of
+ *  EduOM_CreateObjects() and read them back.
+ *
+ * Returns:
+ *  error code
+ */
+static Four apitest_CreateObjects(
+    Four		volId)		/* IN volume of the file */
+{
+    Four		e;		/* error number */
+    Four		n;		/* number of the object */
+    ObjectID		catalogEntry;	/* catalog object of the file */
+    Four		lengths[APITEST_NBATCH];	/* lengths of the objects */
+    char		*data[APITEST_NBATCH];		/* contents of the objects */
+
+
+    e = apitest_NewFile(volId, &catalogEntry);
+    if (e < eNOERROR) return(e);
+
+    for (n = 0; n < APITEST_NBATCH; n++) {
+        lengths[n] = APITEST_LENGTH(n);
+        data[n] = apiData[n];
+    }
+
+    e = EduOM_CreateObjects(&catalogEntry, NULL, APITEST_NBATCH, NULL, lengths, data, apiOid);
+    if (e < eNOERROR) ERR(e);
+
+    e = apitest_CheckFile(&catalogEntry, APITEST_NBATCH);
+    if (e < eNOERROR) return(e);
+
+    return(eNOERROR);
+
+} /* apitest_CreateObjects() */
+
+
+
+/*@================================
+ * apitest_PinObject()
+ *================================*/
+/*
+ * Function: Four apitest_PinObject(Four)
+ *
+ * Description :
+ *  Pin the objects of a file APITEST_NPINS at a time and check their data
+ *  in the buffer; EduOM_CheckPinLeaks() must count the pins held and drop
+ *  to zero once they are released.
+ *
+ * Returns:
+ *  error code
+ */
+static Four apitest_PinObject(
+    Four		volId)		/* IN volume of the file */
+{
+    Four		e;		/* error number */
+    Four		n;		/* number of the object */
+    Four		i;		/* index of the pin */
+    Four		length;		/* length of the pinned object */
+    const void		*ptr;		/* data of the pinned object */
+    ObjectID		catalogEntry;	/* catalog object of the file */
+    PinHandle		handle[APITEST_NPINS];	/* pins held */
+
+
+    e = apitest_NewFile(volId, &catalogEntry);
+    if (e < eNOERROR) return(e);
+
+    for (n = 0; n < APITEST_NPINNED; n++) {
+        e = EduOM_CreateObject(&catalogEntry, (n == 0) ? NULL : &apiOid[n-1], NULL,
+                               APITEST_LENGTH(n), apiData[n], &apiOid[n]);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    APITEST_CHECK(EduOM_CheckPinLeaks() == 0, "no pin is held before the case");
+
+    for (n = 0; n < APITEST_NPINNED; n += APITEST_NPINS) {
+        for (i = 0; i < APITEST_NPINS && n + i < APITEST_NPINNED; i++) {
+            e = EduOM_PinObject(&apiOid[n+i], &ptr, &length, &handle[i]);
+            if (e < eNOERROR) ERR(e);
+
+            APITEST_CHECK(length == APITEST_LENGTH(n+i) && memcmp(ptr, apiData[n+i], length) == 0,
+                          "pinned object holds its contents");
+        }
+
+        APITEST_CHECK(EduOM_CheckPinLeaks() == i, "CheckPinLeaks counts the pins held");
+
+        while (--i >= 0) {
+            e = EduOM_UnpinObject(&handle[i]);
+            if (e < eNOERROR) ERR(e);
+        }
+
+        APITEST_CHECK(EduOM_CheckPinLeaks() == 0, "no pin is left after UnpinObject");
+    }
+
+    e = EduOM_UnpinObject(&handle[0]);
+    APITEST_CHECK(e == eBADPARAMETER_OM, "a handle is unpinned only once");
+
+    e = apitest_CheckFile(&catalogEntry, APITEST_NPINNED);
+    if (e < eNOERROR) return(e);
+
+    return(eNOERROR);
+
+} /* apitest_PinObject() */
+
+
+
+/*@================================
+ * apitest_ScanPageBatch()
+ *================================*/
+/*
+ * Function: Four apitest_ScanPageBatch(Four)
+ *
+ * Description :
+ *  Scan a file by batches of EduOM_ScanPageBatch(). Every batch must come
+ *  from one page and hold the contents of its objects, and the objects
+ *  must be those of EduOM_ScanNext() and EduOM_NextObject() in the same
+ *  order and those of EduOM_PrevObject() in reverse.
+ *
+ * Returns:
+ *  error code
+ */
+static Four apitest_ScanPageBatch(
+    Four		volId)		/* IN volume of the file */
+{
+    Four		e;		/* error number */
+    Four		n;		/* number of the object */
+    Four		i;		/* index in the batch */
+    Four		nBatch;		/* # of objects of the batch */
+    Four		nWalked;	/* # of objects returned by the batches */
+    Four		nFound;		/* # of objects returned by the others */
+    ObjectID		oid;		/* object returned */
+    ObjectID		catalogEntry;	/* catalog object of the file */
+    ScanCursor		cursor;		/* scan of the file */
+    ObjectID		oids[APITEST_BATCHMAX];	/* objects of the batch */
+    ObjectHdr		hdrs[APITEST_BATCHMAX];	/* headers of the objects */
+    const char		*ptrs[APITEST_BATCHMAX];	/* data of the objects */
+
+
+    e = apitest_NewFile(volId, &catalogEntry);
+    if (e < eNOERROR) return(e);
+
+    for (n = 0; n < APITEST_NSCANNED; n++) {
+        e = EduOM_CreateObject(&catalogEntry, (n == 0) ? NULL : &apiOid[n-1], NULL,
+                               APITEST_LENGTH(n), apiData[n], &apiOid[n]);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    e = EduOM_OpenScan(&catalogEntry, &cursor);
+    if (e < eNOERROR) ERR(e);
+
+    nWalked = 0;
+    while ((nBatch = EduOM_ScanPageBatch(&cursor, oids, hdrs, ptrs, APITEST_BATCHMAX)) > 0) {
+        for (i = 0; i < nBatch; i++) {
+            for (n = 0; n < APITEST_NSCANNED; n++)
+                if (EQUAL_PAGEID(apiOid[n], oids[i]) && apiOid[n].slotNo == oids[i].slotNo) break;
+
+            if (n == APITEST_NSCANNED || oids[i].pageNo != oids[0].pageNo ||
+                hdrs[i].length != APITEST_LENGTH(n) || memcmp(ptrs[i], apiData[n], APITEST_LENGTH(n)) != 0 ||
+                nWalked == APITEST_NSCANNED)
+                break;
+
+            apiWalk[nWalked++] = oids[i];
+        }
+        if (i < nBatch) break;
+    }
+
+    e = EduOM_CloseScan(&cursor);
+    if (e < eNOERROR) ERR(e);
+    if (nBatch < eNOERROR) ERR(nBatch);
+
+    APITEST_CHECK(nBatch == 0, "a batch holds the objects of one page with their contents");
+    APITEST_CHECK(nWalked == APITEST_NSCANNED, "ScanPageBatch returns every object");
+
+    e = EduOM_OpenScan(&catalogEntry, &cursor);
+    if (e < eNOERROR) ERR(e);
+
+    nFound = 0;
+    while ((e = EduOM_ScanNext(&cursor, &oid, NULL)) == eNOERROR) {
+        if (nFound == nWalked || !EQUAL_PAGEID(oid, apiWalk[nFound]) ||
+            oid.slotNo != apiWalk[nFound].slotNo)
+            break;
+        nFound++;
+    }
+
+    (Four) EduOM_CloseScan(&cursor);
+    if (e < eNOERROR) ERR(e);
+
+    APITEST_CHECK(nFound == nWalked, "ScanNext returns the objects of ScanPageBatch in order");
+
+    nFound = 0;
+    e = EduOM_NextObject(&catalogEntry, NULL, &oid, NULL);
+    while (e == eNOERROR) {
+        APITEST_CHECK(nFound < nWalked && EQUAL_PAGEID(oid, apiWalk[nFound]) &&
+                      oid.slotNo == apiWalk[nFound].slotNo,
+                      "NextObject returns the objects of ScanPageBatch in order");
+        nFound++;
+        e = EduOM_NextObject(&catalogEntry, &oid, &oid, NULL);
+    }
+    if (e < eNOERROR) ERR(e);
+
+    APITEST_CHECK(nFound == nWalked, "NextObject returns every object");
+
+    nFound = 0;
+    e = EduOM_PrevObject(&catalogEntry, NULL, &oid, NULL);
+    while (e == eNOERROR) {
+        APITEST_CHECK(nFound < nWalked && EQUAL_PAGEID(oid, apiWalk[nWalked - 1 - nFound]) &&
+                      oid.slotNo == apiWalk[nWalked - 1 - nFound].slotNo,
+                      "PrevObject returns the objects of ScanPageBatch in reverse");
+        nFound++;
+        e = EduOM_PrevObject(&catalogEntry, &oid, &oid, NULL);
+    }
+    if (e < eNOERROR) ERR(e);
+
+    APITEST_CHECK(nFound == nWalked, "PrevObject returns every object");
+
+    return(eNOERROR);
+
+} /* apitest_ScanPageBatch() */
+
+
+
+/*@================================
+ * apitest_BulkLoad()
+ *================================*/
+/*
+ * Function: Four apitest_BulkLoad(Four)
+ *
+ * Description :
+ *  Load APITEST_NLOADED objects into a new file by a bulk load and read
+ *  them back.
+ *
+ * Returns:
+ *  error code
+ */
+static Four apitest_BulkLoad(
+    Four		volId)		/* IN volume of the file */
+{
+    Four		e;		/* error number */
+    Four		n;		/* number of the object */
+    ObjectID		catalogEntry;	/* catalog object of the file */
+    BulkLoadHandle	handle;		/* the bulk load */
+
+
+    e = apitest_NewFile(volId, &catalogEntry);
+    if (e < eNOERROR) return(e);
+
+    e = EduOM_InitBulkLoad(&catalogEntry, APITEST_FILLFACTOR, &handle);
+    if (e < eNOERROR) ERR(e);
+
+    for (n = 0; n < APITEST_NLOADED; n++) {
+        e = EduOM_NextBulkLoad(&handle, NULL, APITEST_LENGTH(n), apiData[n], &apiOid[n]);
+        if (e < eNOERROR) {
+            (Four) EduOM_FinalBulkLoad(&handle);
+            ERR(e);
+        }
+    }
+
+    e = EduOM_FinalBulkLoad(&handle);
+    if (e < eNOERROR) ERR(e);
+
+    e = apitest_CheckFile(&catalogEntry, APITEST_NLOADED);
+    if (e < eNOERROR) return(e);
+
+    return(eNOERROR);
+
+} /* apitest_BulkLoad() */
+
+
+
+/*@================================
+ * apitest_SequentialScan()
+ *================================*/
+/*
+ * Function: Four apitest_SequentialScan(ObjectID*, Four*)
+ *
+ * Description :
+ *  Scan the file with a scan opened by EduOM_OpenSequentialScan(); the
+ *  objects must be those of EduOM_NextObject() in the same order.
+ *
+ * Returns:
+ *  error code
+ *
+ * Side Effects :
+ *  1) parameter nFound
+ *     'nFound' is set to the # of objects scanned
+ */
+static Four apitest_SequentialScan(
+    ObjectID		*catObjForFile,	/* IN file to scan */
+    Four		*nFound)	/* OUT # of objects scanned */
+{
+    Four		e;		/* error number */
+    Four		eScan;		/* error number of the scan */
+    ObjectID		oid;		/* object of the scan */
+    ObjectID		nextOid;	/* object of NextObject */
+    ScanCursor		cursor;		/* scan of the file */
+
+
+    e = EduOM_OpenSequentialScan(catObjForFile, &cursor);
+    if (e < eNOERROR) ERR(e);
+
+    *nFound = 0;
+    e = EduOM_NextObject(catObjForFile, NULL, &nextOid, NULL);
+    while ((eScan = EduOM_ScanNext(&cursor, &oid, NULL)) == eNOERROR) {
+        if (e != eNOERROR || !EQUAL_PAGEID(oid, nextOid) || oid.slotNo != nextOid.slotNo) break;
+        (*nFound)++;
+
+        e = EduOM_NextObject(catObjForFile, &nextOid, &nextOid, NULL);
+    }
+
+    (Four) EduOM_CloseScan(&cursor);
+    if (eScan < eNOERROR) ERR(eScan);
+    if (e < eNOERROR) ERR(e);
+
+    APITEST_CHECK(eScan == EOS && e == EOS, "the scan returns the objects of NextObject in order");
+
+    return(eNOERROR);
+
+} /* apitest_SequentialScan() */
+
+
+
+/*@================================
+ * apitest_OpenSequentialScan()
+ *================================*/
+/*
+ * Function: Four apitest_OpenSequentialScan(Four)
+ *
+ * Description :
+ *  Scan a file by EduOM_OpenSequentialScan(), then scan it again while an
+ *  object is pinned; the pinned object must keep its contents.
+ *
+ * Returns:
+ *  error code
+ */
+static Four apitest_OpenSequentialScan(
+    Four		volId)		/* IN volume of the file */
+{
+    Four		e;		/* error number */
+    Four		n;		/* number of the object */
+    Four		nFound;		/* # of objects scanned */
+    Four		length;		/* length of the pinned object */
+    const void		*ptr;		/* data of the pinned object */
+    ObjectID		catalogEntry;	/* catalog object of the file */
+    PinHandle		handle;		/* pin of the first object */
+
+
+    e = apitest_NewFile(volId, &catalogEntry);
+    if (e < eNOERROR) return(e);
+
+    for (n = 0; n < APITEST_NSEQSCANNED; n++) {
+        e = EduOM_CreateObject(&catalogEntry, (n == 0) ? NULL : &apiOid[n-1], NULL,
+                               APITEST_LENGTH(n), apiData[n], &apiOid[n]);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    e = apitest_SequentialScan(&catalogEntry, &nFound);
+    if (e < eNOERROR) return(e);
+    APITEST_CHECK(nFound == APITEST_NSEQSCANNED, "the sequential scan visits every object");
+
+    e = EduOM_PinObject(&apiOid[0], &ptr, &length, &handle);
+    if (e < eNOERROR) ERR(e);
+
+    e = apitest_SequentialScan(&catalogEntry, &nFound);
+    if (e < eNOERROR) {
+        (Four) EduOM_UnpinObject(&handle);
+        return(e);
+    }
+
+    APITEST_CHECK(nFound == APITEST_NSEQSCANNED, "the sequential scan visits every object while pinned");
+    APITEST_CHECK(length == APITEST_LENGTH(0) && memcmp(ptr, apiData[0], length) == 0,
+                  "the pinned object keeps its contents during the scan");
+
+    e = EduOM_UnpinObject(&handle);
+    if (e < eNOERROR) ERR(e);
+
+    e = apitest_CheckFile(&catalogEntry, APITEST_NSEQSCANNED);
+    if (e < eNOERROR) return(e);
+
+    return(eNOERROR);
+
+} /* apitest_OpenSequentialScan() */
+
+
+
+/*@================================
+ * apitest_FlushDirtyPages()
+ *================================*/
+/*
+ * Function: Four apitest_FlushDirtyPages(Four, Four*)
+ *
+ * Description :
+ *  Dirty the pages of a new file, write out one of the queued pages and
+ *  then the rest; the queue must shrink by the pages taken from it and the
+ *  counter of the pages flushed must grow by those written.
+ *
+ * Returns:
+ *  error code
+ *
+ * Side Effects :
+ *  1) parameter nTotal
+ *     'nTotal' is set to the # of pages written
+ */
+static Four apitest_FlushDirtyPages(
+    Four		volId,		/* IN volume of the file */
+    Four		*nTotal)	/* OUT # of pages written */
+{
+    Four		e;		/* error number */
+    Four		n;		/* number of the object */
+    Four		nFlushed;	/* # of pages written by a call */
+    Four		nQueued;	/* # of pages queued after the insertions */
+    Four		nPagesFlushed;	/* counter before the flushes */
+    ObjectID		catalogEntry;	/* catalog object of the file */
+    EduOM_Statistics	stat;		/* counters of EduOM */
+
+
+    /*@ start from an empty queue */
+    e = EduOM_GetStatistics(&stat);
+    if (e < eNOERROR) ERR(e);
+
+    e = EduOM_FlushDirtyPages(stat.nDirtyQueued, NULL);
+    if (e < eNOERROR) ERR(e);
+
+    e = apitest_NewFile(volId, &catalogEntry);
+    if (e < eNOERROR) return(e);
+
+    for (n = 0; n < APITEST_NFLUSHED; n++) {
+        e = EduOM_CreateObject(&catalogEntry, (n == 0) ? NULL : &apiOid[n-1], NULL,
+                               APITEST_LENGTH(n), apiData[n], &apiOid[n]);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    e = EduOM_GetStatistics(&stat);
+    if (e < eNOERROR) ERR(e);
+
+    nQueued = stat.nDirtyQueued;
+    nPagesFlushed = stat.nPagesFlushed;
+    APITEST_CHECK(nQueued > 1, "the insertions queue their dirty pages");
+
+    e = EduOM_FlushDirtyPages(1, &nFlushed);
+    if (e < eNOERROR) ERR(e);
+    *nTotal = nFlushed;
+
+    e = EduOM_GetStatistics(&stat);
+    if (e < eNOERROR) ERR(e);
+
+    APITEST_CHECK(nFlushed <= 1 && stat.nDirtyQueued == nQueued - 1,
+                  "FlushDirtyPages takes at most 'maxPages' pages from the queue");
+
+    e = EduOM_FlushDirtyPages(nQueued, &nFlushed);
+    if (e < eNOERROR) ERR(e);
+    *nTotal += nFlushed;
+
+    e = EduOM_GetStatistics(&stat);
+    if (e < eNOERROR) ERR(e);
+
+    APITEST_CHECK(stat.nDirtyQueued == 0, "FlushDirtyPages empties the queue");
+    APITEST_CHECK(*nTotal > 0 && stat.nPagesFlushed == nPagesFlushed + *nTotal,
+                  "nPagesFlushed counts the pages written");
+
+    e = EduOM_FlushDirtyPages(-1, NULL);
+    APITEST_CHECK(e == eBADPARAMETER_OM, "a negative 'maxPages' is rejected");
+
+    e = apitest_CheckFile(&catalogEntry, APITEST_NFLUSHED);
+    if (e < eNOERROR) return(e);
+
+    return(eNOERROR);
+
+} /* apitest_FlushDirtyPages() */
+
+
+
+/*@================================
+ * EduOM_Test()
+ *================================*/
+/*
+ * Function: Four EduOM_Test(Four, Four, Boolean)
+ *
+ * Description :
+ *  Run the cases in turn; a case failing stops the test.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four EduOM_Test(Four volId, Four handle, Boolean getcharFlag)
+{
+    Four		e;		/* error number */
+    Four		nFlushed;	/* # of pages written by the flush case */
+
+
+    apitest_Fill(APITEST_NOBJECTS);
+
+    e = apitest_CreateObjects(volId);
+    if (e < eNOERROR) return(e);
+    printf("PASS : EduOM_CreateObjects() of %ld objects\n", (long)APITEST_NBATCH);
+
+    e = apitest_PinObject(volId);
+    if (e < eNOERROR) return(e);
+    printf("PASS : EduOM_PinObject() of %ld objects without pin leaks\n", (long)APITEST_NPINNED);
+
+    e = apitest_ScanPageBatch(volId);
+    if (e < eNOERROR) return(e);
+    printf("PASS : EduOM_ScanPageBatch() of %ld objects\n", (long)APITEST_NSCANNED);
+
+    e = apitest_BulkLoad(volId);
+    if (e < eNOERROR) return(e);
+    printf("PASS : bulk load of %ld objects\n", (long)APITEST_NLOADED);
+
+    e = apitest_OpenSequentialScan(volId);
+    if (e < eNOERROR) return(e);
+    printf("PASS : EduOM_OpenSequentialScan() of %ld objects\n", (long)APITEST_NSEQSCANNED);
+
+    e = apitest_FlushDirtyPages(volId, &nFlushed);
+    if (e < eNOERROR) return(e);
+    printf("PASS : EduOM_FlushDirtyPages() of %ld pages\n", (long)nFlushed);
+
+    printf("EduOM_ApiTest passed\n");
+
+    return(eNOERROR);
+
+} /* EduOM_Test() */
@@ -0,0 +1,435 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_AppendToObject.c
+ * 
+ * Description : 
+ *  EduOM_AppendToObject() appends data to the end of an object. An object
+ *  growing beyond a page is converted into a large object whose data are
+ *  kept by the large object manager.
+ *
+ * Exports:
+ *  Four EduOM_AppendToObject(ObjectID*, ObjectID*, Four, char*, Pool*, DeallocListElem*)
+ */
+
+
+#include <string.h>
+#include "EduOM_common.h"
+#include "EduOM.h"		/* for the EduOM interface call */
+#include "BfM.h"		/* for the buffer manager call */
+#include "LOT.h"		/* for the large object manager call */
+#include "EduOM_Internal.h"
+
+
+
+/*@================================
+ * eduom_MoveRecordToEnd()
+ *================================*/
+/*
+ * Function: static Four eduom_MoveRecordToEnd(SlottedPage*, Two)
+ *
+ * Description :
+ *  LOT makes room for a growing root in the page with OM_CompactPage(),
+ *  which takes ALIGN bytes for an object of length 0 while EduOM keeps no
+ *  data bytes for it. Before a root in the page is made or grows, move its
+ *  record to the end of the data area with EduOM_CompactPage() so that LOT
+ *  finds all the free space of the page right after the record and never
+ *  compacts the page itself.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_MoveRecordToEnd(
+    SlottedPage	*apage,		/* INOUT page holding the record */
+    Two		slotNo)		/* IN slot of the record */
+{
+    Four        e;		/* error number */
+    Object      *obj;		/* the record */
+
+
+    obj = (Object *)&(apage->data[apage->slot[-slotNo].offset]);
+
+    if (apage->header.unused > 0 ||
+        apage->slot[-slotNo].offset + OBJ_RECORD_SIZE(obj) != apage->header.free) {
+        e = EduOM_CompactPage(apage, slotNo);
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* eduom_MoveRecordToEnd() */
+
+
+
+/*@================================
+ * eduom_AppendToLargeObject()
+ *================================*/
+/*
+ * Function: static Four eduom_AppendToLargeObject(ObjectID*, PageID*, SlottedPage*, Two, Four, char*)
+ *
+ * Description :
+ *  Append 'length' bytes of 'data' to the large object in the slot 'slotNo'
+ *  of the page 'pid' fixed in the buffer. The data are handed to the large
+ *  object manager as they are; they are not copied.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_AppendToLargeObject(
+    ObjectID	*catObjForFile,	/* IN file containing the object */
+    PageID	*pid,		/* IN page holding the record of the object */
+    SlottedPage	*apage,		/* INOUT buffer holding the page */
+    Two		slotNo,		/* IN slot of the record */
+    Four	length,		/* IN amount of data to append */
+    char	*data)		/* IN data to append */
+{
+    Four        e;		/* error number */
+    Object      *obj;		/* record of the object */
+
+
+    if (length == 0) return(eNOERROR);
+
+    obj = (Object *)&(apage->data[apage->slot[-slotNo].offset]);
+    if (obj->header.properties & P_LRGOBJ_ROOTWITHHDR) {
+        e = eduom_MoveRecordToEnd(apage, slotNo);
+        if (e < 0) ERR(e);
+    }
+
+    e = LOT_AppendToObject(catObjForFile, pid, slotNo, length, data);
+    if (e < 0) ERR(e);
+
+    /* LOT may have moved the record in the page */
+    obj = (Object *)&(apage->data[apage->slot[-slotNo].offset]);
+    obj->header.length += length;
+
+    return(eNOERROR);
+
+} /* eduom_AppendToLargeObject() */
+
+
+
+/*@================================
+ * eduom_ConvertStubToLarge()
+ *================================*/
+/*
+ * Function: static Four eduom_ConvertStubToLarge(ObjectID*, ObjectID*, Four, char*, Four, char*, Pool*, DeallocListElem*)
+ *
+ * Description :
+ *  A large object is never moved, so a moved object becoming a large object
+ *  is converted in the slot of its stub. The caller removes the forwarded
+ *  record only after this succeeds, so that the object is not lost if the
+ *  conversion fails. The stub becomes a small object holding the
+ *  first bytes of the old data, which is converted into a large object, and
+ *  the rest of the old data and the new data are appended to it. A page
+ *  holding only stubs is put back into the page list of the file.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_ConvertStubToLarge(
+    ObjectID	*catObjForFile,	/* IN file containing the object */
+    ObjectID	*stubOid,	/* IN the stub of the object */
+    Four	oldLength,	/* IN length of the old data */
+    char	*oldData,	/* IN old data of the object */
+    Four	length,		/* IN amount of data to append */
+    char	*data,		/* IN data to append */
+    Pool	*dlPool,	/* INOUT pool of dealloc list elements */
+    DeallocListElem *dlHead)	/* INOUT head of dealloc list */
+{
+    Four        e;		/* error number */
+    PageID      pid;		/* page holding the stub */
+    PageID      lastPid;	/* last page of the file */
+    SlottedPage *apage;		/* buffer holding the page */
+    Object      *stub;		/* the stub */
+    Four        freeSpace;	/* free space of the page before */
+    sm_CatOverlayForData *catEntry; /* cached catalog information of the file */
+
+
+    MAKE_PAGEID(pid, stubOid->volNo, stubOid->pageNo);
+    e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    freeSpace = SP_FREE(apage);
+
+    /*@ turn the stub into a small object of LRGOBJ_MIN_LENGTH bytes */
+    e = eduom_ResizeInPage(apage, stubOid->slotNo, LRGOBJ_MIN_LENGTH);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    stub = (Object *)&(apage->data[apage->slot[-(stubOid->slotNo)].offset]);
+    stub->header.properties &= ~P_MOVED;
+    memcpy(stub->data, oldData, LRGOBJ_MIN_LENGTH);
+
+    /*@ convert it and append the rest */
+    e = eduom_MoveRecordToEnd(apage, stubOid->slotNo);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = LOT_ConvertToLarge(catObjForFile, apage, stubOid->slotNo, dlPool, dlHead);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = eduom_AppendToLargeObject(catObjForFile, &pid, apage, stubOid->slotNo,
+                                  oldLength - LRGOBJ_MIN_LENGTH, &oldData[LRGOBJ_MIN_LENGTH]);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = eduom_AppendToLargeObject(catObjForFile, &pid, apage, stubOid->slotNo, length, data);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    /*@ move the page in the available space lists */
+    if (apage->header.flags & SP_STUBPAGE) {
+        /* the page holds an object again; link it after the last page */
+        apage->header.flags &= ~SP_STUBPAGE;
+
+        e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        MAKE_PAGEID(lastPid, pid.volNo, catEntry->lastPage);
+        e = om_FileMapAddPage(catObjForFile, &lastPid, &pid);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        /* om_FileMapAddPage() updates the catalog page directly */
+        e = eduom_RefreshCatalogEntry(catObjForFile, catEntry);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = eduom_PutInAvailSpaceList(catObjForFile, &pid, apage);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+    } else {
+        e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+    }
+
+    e = eduom_SetDirty(&pid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* eduom_ConvertStubToLarge() */
+
+
+
+/*@================================
+ * EduOM_AppendToObject()
+ *================================*/
+/*
+ * Function: Four EduOM_AppendToObject(ObjectID*, ObjectID*, Four, char*, Pool*, DeallocListElem*)
+ * 
+ * Description : 
+ *  (1) What to do?
+ *  EduOM_AppendToObject() appends 'length' bytes of 'data' to the end of
+ *  the object 'oid'. A large payload can be written piece by piece with
+ *  successive calls, so that the whole object need not be in memory.
+ *  The ObjectID of the object does not change.
+ *
+ *  (2) How to do?
+ *  a. Fix the page holding the record of the object following its stub
+ *  b. IF large object THEN
+ *         append the data by LOT
+ *     ELSE IF the longer object fits in the page THEN
+ *         resize the record in place and copy the data
+ *     ELSE IF the longer object fits in a page THEN
+ *         update the object with the old and the new data
+ *     ELSE
+ *         lengthen the object to LRGOBJ_MIN_LENGTH bytes if it is shorter
+ *         convert the object into a large object by LOT, in the slot of its
+ *         stub if the object was moved, and append the data by LOT
+ *         remove the forwarded record of a moved object after the conversion
+ *     ENDIF
+ *  c. Move the pages in the available space lists
+ *
+ * Returns:
+ *  error code
+ *    eBADCATALOGOBJECT_OM
+ *    eBADOBJECTID_OM
+ *    eBADLENGTH_OM
+ *    eBADUSERBUF_OM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter dlHead
+ *     the pages freed by the large object manager are added to the dealloc list
+ */
+Four EduOM_AppendToObject(
+    ObjectID	*catObjForFile,	/* IN file containing the object */
+    ObjectID	*oid,		/* IN object to append to */
+    Four	length,		/* IN amount of data to append */
+    char	*data,		/* IN data to append */
+    Pool	*dlPool,	/* INOUT pool of dealloc list elements */
+    DeallocListElem *dlHead)	/* INOUT head of dealloc list */
+{
+    Four        e;		/* error number */
+    PageID      pid;		/* page holding the record of the object */
+    SlottedPage *apage;		/* buffer holding the page */
+    Object      *obj;		/* record of the object */
+    ObjectID    loc;		/* ObjectID of the record */
+    ObjectID    stubOid;	/* the stub of a moved object */
+    Four        oldLen;		/* length of the object before */
+    Four        recLen;		/* new length of the record */
+    Four        freeSpace;	/* free space of the page before */
+    Four        n;		/* # of bytes taken to lengthen a short object */
+    Boolean     forwarded;	/* TRUE if the record is a forwarded record */
+    char        buf[PAGESIZE];	/* data of a small object */
+
+
+    /*@ check parameters */
+    if (catObjForFile == NULL) ERR(eBADCATALOGOBJECT_OM);
+
+    if (oid == NULL) ERR(eBADOBJECTID_OM);
+
+    if (length < 0) ERR(eBADLENGTH_OM);
+
+    if (data == NULL && length > 0) ERR(eBADUSERBUF_OM);
+
+    e = eduom_FixObject(oid, &pid, &apage, &obj, &loc);
+    if (e < 0) ERR(e);
+
+    freeSpace = SP_FREE(apage);
+
+    /*@ a large object grows in its large object tree */
+    if (obj->header.properties & P_LRGOBJ) {
+        e = eduom_AppendToLargeObject(catObjForFile, &pid, apage, loc.slotNo, length, data);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = eduom_SetDirty(&pid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    forwarded = (obj->header.properties & P_FORWARDED) ? TRUE : FALSE;
+    oldLen = OBJ_LENGTH(obj);
+    recLen = obj->header.length + length;
+
+    /*@ append in place */
+    if (ALIGNED_LENGTH(recLen) <= LRGOBJ_THRESHOLD &&
+        ALIGNED_LENGTH(recLen) - ALIGNED_LENGTH(obj->header.length) <= freeSpace) {
+        e = eduom_ResizeInPage(apage, loc.slotNo, recLen);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        obj = (Object *)&(apage->data[apage->slot[-(loc.slotNo)].offset]);
+        if (length > 0) memcpy(&(OBJ_DATA(obj)[oldLen]), data, length);
+
+        e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = eduom_SetDirty(&pid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    memcpy(buf, OBJ_DATA(obj), oldLen);
+
+    /*@ move the longer object to another page */
+    if (ALIGNED_LENGTH(oldLen + length + FWD_BACKPTR_LEN) <= LRGOBJ_THRESHOLD) {
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        memcpy(&buf[oldLen], data, length);
+
+        e = EduOM_UpdateObject(catObjForFile, oid, oldLen + length, buf);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    /*@ convert the object into a large object */
+    if (oldLen < LRGOBJ_MIN_LENGTH) {
+        /* the record must be long enough to hold the PageID of the root */
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        n = LRGOBJ_MIN_LENGTH - oldLen;
+        memcpy(&buf[oldLen], data, n);
+
+        e = EduOM_UpdateObject(catObjForFile, oid, LRGOBJ_MIN_LENGTH, buf);
+        if (e < 0) ERR(e);
+
+        return(EduOM_AppendToObject(catObjForFile, oid, length - n, &data[n], dlPool, dlHead));
+    }
+
+    if (forwarded) {
+        memcpy(&stubOid, obj->data, sizeof(ObjectID));
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        /* the record is removed only after the stub holds the object */
+        e = eduom_ConvertStubToLarge(catObjForFile, &stubOid, oldLen, buf, length, data, dlPool, dlHead);
+        if (e < 0) ERR(e);
+
+        e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        freeSpace = SP_FREE(apage);
+
+        e = eduom_RemoveFromPage(apage, loc.slotNo);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = eduom_SetDirty(&pid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    e = eduom_MoveRecordToEnd(apage, loc.slotNo);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = LOT_ConvertToLarge(catObjForFile, apage, loc.slotNo, dlPool, dlHead);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = eduom_AppendToLargeObject(catObjForFile, &pid, apage, loc.slotNo, length, data);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = eduom_SetDirty(&pid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+    
+} /* EduOM_AppendToObject() */
@@ -0,0 +1,268 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_AvailSpaceList.c
+ * 
+ * Description :
+ *  Maintain the available space lists of a data file. A page whose free
+ *  space is N% or more of the page (N = 10, 20, 30, 40, 50) and less than
+ *  the next level is linked in the list availSpaceListN through the
+ *  'spaceListPrev' and 'spaceListNext' fields of the page header.
+ *  The list heads are accessed through the catalog cache. The free space
+ *  map of the file is updated along with the lists.
+ *
+ * Internal Exports:
+ *  Four eduom_PutInAvailSpaceList(ObjectID*, PageID*, SlottedPage*)
+ *  Four eduom_RemoveFromAvailSpaceList(ObjectID*, PageID*, SlottedPage*, Four)
+ *  Four eduom_UpdateAvailSpaceList(ObjectID*, PageID*, SlottedPage*, Four)
+ */
+
+#include "EduOM_common.h"
+#include "BfM.h"		/* for the buffer manager call */
+#include "EduOM_Internal.h"
+
+
+
+/*@================================
+ * eduom_AvailSpaceListHead()
+ *================================*/
+/*
+ * Function: ShortPageID *eduom_AvailSpaceListHead(sm_CatOverlayForData*, Four)
+ *
+ * Description :
+ *  Return the head of the available space list for a page having
+ *  'freeSpace' bytes of free space.
+ *
+ * Returns:
+ *  pointer to the list head, or NULL if such a page is not in any list
+ */
+static ShortPageID *eduom_AvailSpaceListHead(
+    sm_CatOverlayForData *catEntry,	/* IN catalog information of the file */
+    Four		freeSpace)	/* IN free space of the page */
+{
+    if (freeSpace >= SP_50SIZE) return(&catEntry->availSpaceList50);
+    if (freeSpace >= SP_40SIZE) return(&catEntry->availSpaceList40);
+    if (freeSpace >= SP_30SIZE) return(&catEntry->availSpaceList30);
+    if (freeSpace >= SP_20SIZE) return(&catEntry->availSpaceList20);
+    if (freeSpace >= SP_10SIZE) return(&catEntry->availSpaceList10);
+
+    return(NULL);
+
+} /* eduom_AvailSpaceListHead() */
+
+
+
+/*@================================
+ * eduom_PutInAvailSpaceList()
+ *================================*/
+/*
+ * Function: Four eduom_PutInAvailSpaceList(ObjectID*, PageID*, SlottedPage*)
+ *
+ * Description :
+ *  Put the page at the head of the available space list corresponding to
+ *  its current free space. The caller must set the page dirty.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_PutInAvailSpaceList(
+    ObjectID		*catObjForFile,	/* IN file containing the page */
+    PageID		*pid,		/* IN page to put */
+    SlottedPage		*apage)		/* INOUT buffer holding the page */
+{
+    Four		e;		/* error number */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+    ShortPageID		*listHead;	/* head of the list */
+    PageID		nextPid;	/* the page following in the list */
+    SlottedPage		*nextPage;	/* buffer holding the following page */
+
+
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) ERR(e);
+
+    e = eduom_SetFreeSpaceMap(catObjForFile, pid, SP_FREE(apage));
+    if (e < 0) ERR(e);
+
+    listHead = eduom_AvailSpaceListHead(catEntry, SP_FREE(apage));
+    if (listHead == NULL) return(eNOERROR);
+
+    apage->header.spaceListPrev = NIL;
+    apage->header.spaceListNext = *listHead;
+
+    if (*listHead != NIL) {
+        MAKE_PAGEID(nextPid, pid->volNo, *listHead);
+        e = BfM_GetTrain(&nextPid, (char **)&nextPage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        nextPage->header.spaceListPrev = pid->pageNo;
+
+        e = eduom_SetDirty(&nextPid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &nextPid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&nextPid, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    *listHead = pid->pageNo;
+
+    e = eduom_WriteCatalogEntry(catObjForFile, catEntry);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* eduom_PutInAvailSpaceList() */
+
+
+
+/*@================================
+ * eduom_RemoveFromAvailSpaceList()
+ *================================*/
+/*
+ * Function: Four eduom_RemoveFromAvailSpaceList(ObjectID*, PageID*, SlottedPage*, Four)
+ *
+ * Description :
+ *  Remove the page from the available space list into which it was put
+ *  when its free space was 'freeSpace'. Nothing is done if the page is not
+ *  in the list. The caller must set the page dirty.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_RemoveFromAvailSpaceList(
+    ObjectID		*catObjForFile,	/* IN file containing the page */
+    PageID		*pid,		/* IN page to remove */
+    SlottedPage		*apage,		/* INOUT buffer holding the page */
+    Four		freeSpace)	/* IN free space when the page was put */
+{
+    Four		e;		/* error number */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+    ShortPageID		*listHead;	/* head of the list */
+    PageID		nbPid;		/* neighbor page in the list */
+    SlottedPage		*nbPage;	/* buffer holding the neighbor page */
+
+
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) ERR(e);
+
+    e = eduom_ClearFreeSpaceMap(catObjForFile, pid);
+    if (e < 0) ERR(e);
+
+    listHead = eduom_AvailSpaceListHead(catEntry, freeSpace);
+    if (listHead == NULL) return(eNOERROR);
+
+    if (apage->header.spaceListPrev == NIL) {
+        /* the page is the first one of the list or is not in the list */
+        if (*listHead != pid->pageNo) return(eNOERROR);
+
+        *listHead = apage->header.spaceListNext;
+
+        e = eduom_WriteCatalogEntry(catObjForFile, catEntry);
+        if (e < 0) ERR(e);
+
+    } else {
+        MAKE_PAGEID(nbPid, pid->volNo, apage->header.spaceListPrev);
+        e = BfM_GetTrain(&nbPid, (char **)&nbPage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        nbPage->header.spaceListNext = apage->header.spaceListNext;
+
+        e = eduom_SetDirty(&nbPid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &nbPid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&nbPid, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    if (apage->header.spaceListNext != NIL) {
+        MAKE_PAGEID(nbPid, pid->volNo, apage->header.spaceListNext);
+        e = BfM_GetTrain(&nbPid, (char **)&nbPage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        nbPage->header.spaceListPrev = apage->header.spaceListPrev;
+
+        e = eduom_SetDirty(&nbPid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &nbPid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&nbPid, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    apage->header.spaceListPrev = NIL;
+    apage->header.spaceListNext = NIL;
+
+    return(eNOERROR);
+
+} /* eduom_RemoveFromAvailSpaceList() */
+
+
+
+/*@================================
+ * eduom_UpdateAvailSpaceList()
+ *================================*/
+/*
+ * Function: Four eduom_UpdateAvailSpaceList(ObjectID*, PageID*, SlottedPage*, Four)
+ *
+ * Description :
+ *  Move the page, whose free space was 'oldFreeSpace' before it was
+ *  modified, to the available space list corresponding to its current free
+ *  space. If the list does not change, the page stays where it is so that
+ *  neither the catalog page nor the neighbor pages are touched.
+ *  The caller must set the page dirty.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_UpdateAvailSpaceList(
+    ObjectID		*catObjForFile,	/* IN file containing the page */
+    PageID		*pid,		/* IN page modified */
+    SlottedPage		*apage,		/* INOUT buffer holding the page */
+    Four		oldFreeSpace)	/* IN free space before modification */
+{
+    Four		e;		/* error number */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+
+
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) ERR(e);
+
+    e = eduom_SetFreeSpaceMap(catObjForFile, pid, SP_FREE(apage));
+    if (e < 0) ERR(e);
+
+    if (eduom_AvailSpaceListHead(catEntry, oldFreeSpace) ==
+        eduom_AvailSpaceListHead(catEntry, SP_FREE(apage)))
+        return(eNOERROR);
+
+    e = eduom_RemoveFromAvailSpaceList(catObjForFile, pid, apage, oldFreeSpace);
+    if (e < 0) ERR(e);
+
+    e = eduom_PutInAvailSpaceList(catObjForFile, pid, apage);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* eduom_UpdateAvailSpaceList() */
@@ -0,0 +1,539 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_BulkLoad.c
+ * 
+ * Description : 
+ *  Load a large number of objects into a data file. The objects are
+ *  appended to the file in the given order. Instead of going through the
+ *  buffer for each object, the pages are built as images in a private
+ *  buffer, filled up to the fill factor, and written to the disk directly
+ *  EDUOM_BLKLD_NPAGES pages at a time. The pages are allocated the same
+ *  number at a time. The loaded pages are linked to the file and to the
+ *  available space lists in EduOM_FinalBulkLoad().
+ *
+ *  The file must not be updated by other operations during the bulk load.
+ *
+ * Exports:
+ *  Four EduOM_InitBulkLoad(ObjectID*, Four, BulkLoadHandle*)
+ *  Four EduOM_NextBulkLoad(BulkLoadHandle*, ObjectHdr*, Four, char*, ObjectID*)
+ *  Four EduOM_FinalBulkLoad(BulkLoadHandle*)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduOM_common.h"
+#include "RDsM.h"		/* for the raw disk manager call */
+#include "BfM.h"		/* for the buffer manager call */
+#include "EduOM_Internal.h"
+
+
+/* Macro: BLKLD_IMAGE(h, i)
+ * Description: pointer to the i-th page image of the bulk load
+ */
+#define BLKLD_IMAGE(h, i)	((SlottedPage *)&((h)->buf[(i) * PAGESIZE]))
+
+
+
+/*@================================
+ * eduom_BlkLdListNo()
+ *================================*/
+/*
+ * Function: Four eduom_BlkLdListNo(Four)
+ *
+ * Description :
+ *  Return the index of the available space list for a page having
+ *  'freeSpace' bytes of free space: 0 for the list 10, ..., 4 for the
+ *  list 50.
+ *
+ * Returns:
+ *  index of the list, or NIL if such a page is not in any list
+ */
+static Four eduom_BlkLdListNo(
+    Four		freeSpace)	/* IN free space of the page */
+{
+    if (freeSpace >= SP_50SIZE) return(4);
+    if (freeSpace >= SP_40SIZE) return(3);
+    if (freeSpace >= SP_30SIZE) return(2);
+    if (freeSpace >= SP_20SIZE) return(1);
+    if (freeSpace >= SP_10SIZE) return(0);
+
+    return(NIL);
+
+} /* eduom_BlkLdListNo() */
+
+
+
+/*@================================
+ * eduom_BlkLdClosePage()
+ *================================*/
+/*
+ * Function: Four eduom_BlkLdClosePage(BulkLoadHandle*)
+ *
+ * Description :
+ *  Finish the current page image. If the page has enough free space, it is
+ *  put in front of the pages loaded into the same available space list.
+ *  The oldest one of them is linked to the existing list in
+ *  EduOM_FinalBulkLoad().
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_BlkLdClosePage(
+    BulkLoadHandle	*handle)	/* INOUT bulk load handle */
+{
+    Four		e;		/* error number */
+    Four		i;		/* index variable */
+    Four		listNo;		/* available space list of the page */
+    SlottedPage		*apage;		/* current page image */
+    PageID		pid;		/* current page */
+    PageID		nbPid;		/* page loaded before in the same list */
+    SlottedPage		*nbPage;	/* buffer holding that page */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+    ShortPageID		heads[5];	/* heads of the available space lists */
+
+
+    apage = BLKLD_IMAGE(handle, handle->nImages - 1);
+    pid = handle->pids[handle->nImages - 1];
+
+    listNo = eduom_BlkLdListNo(SP_FREE(apage));
+    if (listNo == NIL) return(eNOERROR);
+
+    apage->header.spaceListPrev = NIL;
+
+    if (handle->listNewest[listNo] == NIL) {
+        /* the first page loaded into the list precedes the existing pages */
+        e = eduom_GetCatalogEntry(&(handle->catObjForFile), &catEntry);
+        if (e < 0) ERR(e);
+
+        heads[0] = catEntry->availSpaceList10;
+        heads[1] = catEntry->availSpaceList20;
+        heads[2] = catEntry->availSpaceList30;
+        heads[3] = catEntry->availSpaceList40;
+        heads[4] = catEntry->availSpaceList50;
+
+        apage->header.spaceListNext = heads[listNo];
+        handle->listOldest[listNo] = pid.pageNo;
+
+    } else {
+        apage->header.spaceListNext = handle->listNewest[listNo];
+
+        /* link the previous page back; it may be written already */
+        for (i = 0; i < handle->nImages - 1; i++)
+            if (handle->pids[i].pageNo == handle->listNewest[listNo]) break;
+
+        if (i < handle->nImages - 1)
+            BLKLD_IMAGE(handle, i)->header.spaceListPrev = pid.pageNo;
+        else {
+            MAKE_PAGEID(nbPid, pid.volNo, handle->listNewest[listNo]);
+            e = BfM_GetTrain(&nbPid, (char **)&nbPage, PAGE_BUF);
+            if (e < 0) ERR(e);
+
+            nbPage->header.spaceListPrev = pid.pageNo;
+
+            e = eduom_SetDirty(&nbPid, PAGE_BUF);
+            if (e < 0) ERRB1(e, &nbPid, PAGE_BUF);
+
+            e = BfM_FreeTrain(&nbPid, PAGE_BUF);
+            if (e < 0) ERR(e);
+        }
+    }
+
+    handle->listNewest[listNo] = pid.pageNo;
+
+    return(eNOERROR);
+
+} /* eduom_BlkLdClosePage() */
+
+
+
+/*@================================
+ * eduom_BlkLdFlush()
+ *================================*/
+/*
+ * Function: Four eduom_BlkLdFlush(BulkLoadHandle*)
+ *
+ * Description :
+ *  Write the page images to the disk. Images of the consecutive pages are
+ *  written by one call. Any copy of the pages left in the buffer from
+ *  their former use is discarded first.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_BlkLdFlush(
+    BulkLoadHandle	*handle)	/* INOUT bulk load handle */
+{
+    Four		e;		/* error number */
+    Four		i, j;		/* index variables */
+
+
+    for (i = 0; i < handle->nImages; i++) {
+        e = BfM_RemoveTrain(&(handle->pids[i]), PAGE_BUF, FALSE);
+        if (e < 0) ERR(e);
+    }
+
+    for (i = 0; i < handle->nImages; i = j) {
+        for (j = i + 1; j < handle->nImages; j++)
+            if (handle->pids[j].volNo != handle->pids[i].volNo ||
+                handle->pids[j].pageNo != handle->pids[j - 1].pageNo + 1) break;
+
+        e = RDsM_WriteTrains(&(handle->buf[i * PAGESIZE]), &(handle->pids[i]), j - i, PAGESIZE2);
+        if (e < 0) ERR(e);
+    }
+
+    for (i = 0; i < handle->nImages; i++) {
+        e = eduom_SetFreeSpaceMap(&(handle->catObjForFile), &(handle->pids[i]),
+                                  SP_FREE(BLKLD_IMAGE(handle, i)));
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* eduom_BlkLdFlush() */
+
+
+
+/*@================================
+ * eduom_BlkLdNewPage()
+ *================================*/
+/*
+ * Function: Four eduom_BlkLdNewPage(BulkLoadHandle*)
+ *
+ * Description :
+ *  Finish the current page image and start a new one. When all the pages
+ *  allocated are used, the images are written out and the next
+ *  EDUOM_BLKLD_NPAGES pages are allocated.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_BlkLdNewPage(
+    BulkLoadHandle	*handle)	/* INOUT bulk load handle */
+{
+    Four		e;		/* error number */
+    Four		firstExt;	/* first extent of the file */
+    PageID		newPids[EDUOM_BLKLD_NPAGES]; /* pages newly allocated */
+    PhysicalFileID	pFid;		/* physical ID of the file */
+    SlottedPage		*apage;		/* new page image */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+
+
+    if (handle->nImages > 0) {
+        e = eduom_BlkLdClosePage(handle);
+        if (e < 0) ERR(e);
+    }
+
+    if (handle->nImages == handle->nAllocated) {
+
+        e = eduom_GetCatalogEntry(&(handle->catObjForFile), &catEntry);
+        if (e < 0) ERR(e);
+
+        MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
+        e = RDsM_PageIdToExtNo((PageID *)&pFid, &firstExt);
+        if (e < 0) ERR(e);
+
+        e = RDsM_AllocTrains(catEntry->fid.volNo, firstExt, &(handle->prevPid), catEntry->eff,
+                             EDUOM_BLKLD_NPAGES, PAGESIZE2, newPids);
+        if (e < 0) ERR(e);
+
+        if (handle->nImages > 0) {
+            BLKLD_IMAGE(handle, handle->nImages - 1)->header.nextPage = newPids[0].pageNo;
+
+            e = eduom_BlkLdFlush(handle);
+            if (e < 0) ERR(e);
+        }
+
+        memcpy(handle->pids, newPids, sizeof(newPids));
+        handle->nAllocated = EDUOM_BLKLD_NPAGES;
+        handle->nImages = 0;
+
+    } else if (handle->nImages > 0)
+        BLKLD_IMAGE(handle, handle->nImages - 1)->header.nextPage = handle->pids[handle->nImages].pageNo;
+
+    /*@ start the new page image */
+    e = eduom_GetCatalogEntry(&(handle->catObjForFile), &catEntry);
+    if (e < 0) ERR(e);
+
+    apage = BLKLD_IMAGE(handle, handle->nImages);
+
+    e = eduom_InitSlottedPage(apage, &(handle->pids[handle->nImages]), &(catEntry->fid));
+    if (e < 0) ERR(e);
+
+    apage->header.prevPage = handle->prevPid.pageNo;
+
+    if (handle->firstPage == NIL) handle->firstPage = handle->pids[handle->nImages].pageNo;
+
+    handle->prevPid = handle->pids[handle->nImages];
+    handle->nImages++;
+
+    return(eNOERROR);
+
+} /* eduom_BlkLdNewPage() */
+
+
+
+/*@================================
+ * EduOM_InitBulkLoad()
+ *================================*/
+/*
+ * Function: Four EduOM_InitBulkLoad(ObjectID*, Four, BulkLoadHandle*)
+ * 
+ * Description : 
+ *  Start a bulk load into the data file. The pages are filled with objects
+ *  up to 'fillFactor' percent of their data area, leaving the rest for the
+ *  later insertions and updates.
+ *
+ * Returns:
+ *  error code
+ *    eBADCATALOGOBJECT_OM
+ *    eBADPARAMETER_OM
+ *    eNOMEMORY_EDUOM
+ *    some errors caused by function calls
+ */
+Four EduOM_InitBulkLoad(
+    ObjectID		*catObjForFile,	/* IN file to load */
+    Four		fillFactor,	/* IN % of a page to be filled (1-100) */
+    BulkLoadHandle	*handle)	/* OUT bulk load handle */
+{
+    Four		e;		/* error number */
+    Four		i;		/* index variable */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+
+
+    /*@ check parameters */
+
+    if (catObjForFile == NULL) ERR(eBADCATALOGOBJECT_OM);
+
+    if (handle == NULL || fillFactor < 1 || fillFactor > 100) ERR(eBADPARAMETER_OM);
+
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) ERR(e);
+
+    handle->buf = (char *)malloc(EDUOM_BLKLD_NPAGES * PAGESIZE);
+    if (handle->buf == NULL) ERR(eNOMEMORY_EDUOM);
+
+    handle->catObjForFile = *catObjForFile;
+    handle->fillFactor = fillFactor;
+    handle->nAllocated = 0;
+    handle->nImages = 0;
+    MAKE_PAGEID(handle->prevPid, catEntry->fid.volNo, catEntry->lastPage);
+    handle->oldLastPage = catEntry->lastPage;
+    handle->firstPage = NIL;
+    for (i = 0; i < 5; i++) handle->listNewest[i] = handle->listOldest[i] = NIL;
+
+    return(eNOERROR);
+    
+} /* EduOM_InitBulkLoad() */
+
+
+
+/*@================================
+ * EduOM_NextBulkLoad()
+ *================================*/
+/*
+ * Function: Four EduOM_NextBulkLoad(BulkLoadHandle*, ObjectHdr*, Four, char*, ObjectID*)
+ * 
+ * Description : 
+ *  Append a new object to the file being loaded. The object is put into
+ *  the current page image if it fits within the fill factor; otherwise a
+ *  new page image is started.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_OM
+ *    eBADLENGTH_OM
+ *    eBADUSERBUF_OM
+ *    eNOTSUPPORTED_EDUOM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter oid
+ *     'oid' is set to the ObjectID of the new object
+ */
+Four EduOM_NextBulkLoad(
+    BulkLoadHandle	*handle,	/* INOUT bulk load handle */
+    ObjectHdr		*objHdr,	/* IN from which tag is to be set */
+    Four		length,		/* IN amount of data */
+    char		*data,		/* IN the initial data for the object */
+    ObjectID		*oid)		/* OUT the object's ObjectID */
+{
+    Four		e;		/* error number */
+    Four		used;		/* bytes used in the page after insertion */
+    SlottedPage		*apage;		/* current page image */
+    ObjectHdr		objectHdr;	/* ObjectHdr with tag set from parameter */
+
+
+    /*@ check parameters */
+
+    if (handle == NULL || handle->buf == NULL) ERR(eBADPARAMETER_OM);
+
+    if (length < 0) ERR(eBADLENGTH_OM);
+
+    if (length > 0 && data == NULL) ERR(eBADUSERBUF_OM);
+
+    if (oid == NULL) ERR(eBADOBJECTID_OM);
+
+    if (ALIGNED_LENGTH(length) > LRGOBJ_THRESHOLD) ERR(eNOTSUPPORTED_EDUOM);
+
+    objectHdr.properties = P_CLEAR;
+    objectHdr.tag = (objHdr != NULL) ? objHdr->tag : 0;
+    objectHdr.length = 0;
+
+    /*@ start a new page if the object would exceed the fill factor */
+    if (handle->nImages > 0) {
+        apage = BLKLD_IMAGE(handle, handle->nImages - 1);
+        used = apage->header.free + sizeof(ObjectHdr) + ALIGNED_LENGTH(length) +
+               apage->header.nSlots * sizeof(SlottedPageSlot);
+    }
+
+    if (handle->nImages == 0 ||
+        (apage->header.free > 0 && used * 100 > handle->fillFactor * (PAGESIZE - SP_FIXED))) {
+        e = eduom_BlkLdNewPage(handle);
+        if (e < 0) ERR(e);
+
+        apage = BLKLD_IMAGE(handle, handle->nImages - 1);
+    }
+
+    e = eduom_InsertInPage(apage, &objectHdr, length, data, oid);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+    
+} /* EduOM_NextBulkLoad() */
+
+
+
+/*@================================
+ * EduOM_FinalBulkLoad()
+ *================================*/
+/*
+ * Function: Four EduOM_FinalBulkLoad(BulkLoadHandle*)
+ * 
+ * Description : 
+ *  (1) What to do?
+ *  EduOM_FinalBulkLoad() finishes the bulk load: the remaining page images
+ *  are written and the loaded pages are linked to the file. The buffer of
+ *  the page images is freed even if writing them fails.
+ *
+ *  (2) How to do?
+ *  a. Write the remaining page images and free their buffer
+ *  b. Free the pages allocated but not used
+ *  c. Link the loaded pages after the former last page of the file
+ *  d. Link the loaded pages in front of the available space lists
+ *  e. Write the catalog information
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_OM
+ *    some errors caused by function calls
+ */
+Four EduOM_FinalBulkLoad(
+    BulkLoadHandle	*handle)	/* INOUT bulk load handle */
+{
+    Four		e;		/* error number */
+    Four		i;		/* index variable */
+    PageID		pid;		/* page to be linked */
+    SlottedPage		*apage;		/* buffer holding the page */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+    ShortPageID		*heads[5];	/* heads of the available space lists */
+
+
+    if (handle == NULL || handle->buf == NULL) ERR(eBADPARAMETER_OM);
+
+    /*@ write the remaining page images */
+    e = eNOERROR;
+    if (handle->nImages > 0) {
+        e = eduom_BlkLdClosePage(handle);
+        if (e >= 0) e = eduom_BlkLdFlush(handle);
+    }
+
+    free(handle->buf);
+    handle->buf = NULL;
+
+    if (e < 0) ERR(e);
+
+    for (i = handle->nImages; i < handle->nAllocated; i++) {
+        e = RDsM_FreeTrain(&(handle->pids[i]), PAGESIZE2);
+        if (e < 0) ERR(e);
+    }
+
+    if (handle->firstPage == NIL) return(eNOERROR);
+
+    e = eduom_GetCatalogEntry(&(handle->catObjForFile), &catEntry);
+    if (e < 0) ERR(e);
+
+    /*@ link the loaded pages after the former last page */
+    MAKE_PAGEID(pid, catEntry->fid.volNo, handle->oldLastPage);
+    e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    apage->header.nextPage = handle->firstPage;
+
+    e = eduom_SetDirty(&pid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    catEntry->lastPage = handle->prevPid.pageNo;
+
+    /*@ link the loaded pages in front of the available space lists */
+    heads[0] = &(catEntry->availSpaceList10);
+    heads[1] = &(catEntry->availSpaceList20);
+    heads[2] = &(catEntry->availSpaceList30);
+    heads[3] = &(catEntry->availSpaceList40);
+    heads[4] = &(catEntry->availSpaceList50);
+
+    for (i = 0; i < 5; i++) {
+        if (handle->listNewest[i] == NIL) continue;
+
+        if (*heads[i] != NIL) {
+            MAKE_PAGEID(pid, catEntry->fid.volNo, *heads[i]);
+            e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+            if (e < 0) ERR(e);
+
+            apage->header.spaceListPrev = handle->listOldest[i];
+
+            e = eduom_SetDirty(&pid, PAGE_BUF);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+            e = BfM_FreeTrain(&pid, PAGE_BUF);
+            if (e < 0) ERR(e);
+        }
+
+        *heads[i] = handle->listNewest[i];
+    }
+
+    e = eduom_WriteCatalogEntry(&(handle->catObjForFile), catEntry);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+    
+} /* EduOM_FinalBulkLoad() */
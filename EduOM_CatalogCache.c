@@ -0,0 +1,269 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_CatalogCache.c
+ * 
+ * Description :
+ *  Keep in memory a copy of the catalog information(sm_CatOverlayForData)
+ *  of the data files used by EduOM so that the catalog page need not be
+ *  read on every operation. The copy is written through to the catalog page
+ *  whenever EduOM changes it.
+ *
+ *  A cached copy is not checked against the catalog page again, so changes
+ *  made to the catalog information outside EduOM are not seen. The
+ *  om_FileMapAddPage() and om_FileMapDeletePage() calls EduOM makes itself
+ *  are followed by eduom_RefreshCatalogEntry(). Every other change needs
+ *  EduOM_InvalidateCatalogCache() before the next EduOM call on the file:
+ *  - SM_DestroyFile(): invalidate the destroyed file. A later
+ *    SM_CreateFile() may reuse its catalog object for another file, which
+ *    would otherwise be given the old copy.
+ *  - an aborted transaction (LRDS_AbortTransaction()): invalidate the
+ *    whole cache, since the catalog pages may be rolled back.
+ *  - creating or destroying objects of the file through the storage
+ *    system (SM_ or LRDS_ calls) instead of EduOM: these change the page
+ *    list and the available space lists on the catalog page.
+ *  - dismounting the volume (LRDS_Dismount()): invalidate the whole cache.
+ *
+ * Exports:
+ *  Four EduOM_InvalidateCatalogCache(ObjectID*)
+ *
+ * Internal Exports:
+ *  Four eduom_GetCatalogEntry(ObjectID*, sm_CatOverlayForData**)
+ *  Four eduom_WriteCatalogEntry(ObjectID*, sm_CatOverlayForData*)
+ *  Four eduom_RefreshCatalogEntry(ObjectID*, sm_CatOverlayForData*)
+ */
+
+#include <string.h>
+#include "EduOM_common.h"
+#include "BfM.h"		/* for the buffer manager call */
+#include "EduOM_Internal.h"
+
+
+/* number of data files whose catalog information is kept in memory */
+#define EDUOM_CATCACHE_SIZE	16
+
+/*
+ * Typedef for an entry of the catalog cache
+ */
+typedef struct {
+	Boolean		valid;		/* TRUE if the entry holds a copy */
+	ObjectID	catObjForFile;	/* catalog object of the data file */
+	sm_CatOverlayForData catEntry;	/* copy of the catalog information */
+} eduom_CatCacheEntry;
+
+static eduom_CatCacheEntry eduom_catCache[EDUOM_CATCACHE_SIZE];
+static Four eduom_catCacheVictim = 0;	/* next entry to be replaced */
+
+
+/* Macro: EQUAL_OBJECTID(x, y)
+ * Description: check whether the two object IDs are equal
+ */
+#define EQUAL_OBJECTID(x, y) \
+	(((x).volNo == (y).volNo && (x).pageNo == (y).pageNo && \
+	  (x).slotNo == (y).slotNo && (x).unique == (y).unique) ? TRUE : FALSE)
+
+
+
+/*@================================
+ * eduom_GetCatalogEntry()
+ *================================*/
+/*
+ * Function: Four eduom_GetCatalogEntry(ObjectID*, sm_CatOverlayForData**)
+ *
+ * Description :
+ *  Return the cached copy of the catalog information of the data file.
+ *  On a miss the catalog page is read once and the copy is cached.
+ *  The returned pointer stays valid until the entry is replaced by another
+ *  data file, i.e. during one EduOM operation.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter catEntry
+ *     'catEntry' points to the cached copy of the catalog information
+ */
+Four eduom_GetCatalogEntry(
+    ObjectID		*catObjForFile,	/* IN catalog object of the data file */
+    sm_CatOverlayForData **catEntry)	/* OUT cached catalog information */
+{
+    Four		e;		/* error number */
+    Four		i;		/* index variable */
+    eduom_CatCacheEntry	*entry;		/* cache entry */
+
+
+    for (i = 0; i < EDUOM_CATCACHE_SIZE; i++) {
+        entry = &eduom_catCache[i];
+        if (entry->valid && EQUAL_OBJECTID(entry->catObjForFile, *catObjForFile)) {
+            *catEntry = &(entry->catEntry);
+            return(eNOERROR);
+        }
+    }
+
+    /*@ miss: load the catalog information into a free or victim entry */
+    for (i = 0; i < EDUOM_CATCACHE_SIZE; i++)
+        if (!eduom_catCache[i].valid) break;
+
+    if (i == EDUOM_CATCACHE_SIZE) {
+        i = eduom_catCacheVictim;
+        eduom_catCacheVictim = (eduom_catCacheVictim + 1) % EDUOM_CATCACHE_SIZE;
+    }
+
+    entry = &eduom_catCache[i];
+    entry->valid = FALSE;
+
+    e = eduom_RefreshCatalogEntry(catObjForFile, &(entry->catEntry));
+    if (e < 0) ERR(e);
+
+    entry->catObjForFile = *catObjForFile;
+    entry->valid = TRUE;
+
+    *catEntry = &(entry->catEntry);
+
+    return(eNOERROR);
+
+} /* eduom_GetCatalogEntry() */
+
+
+
+/*@================================
+ * eduom_WriteCatalogEntry()
+ *================================*/
+/*
+ * Function: Four eduom_WriteCatalogEntry(ObjectID*, sm_CatOverlayForData*)
+ *
+ * Description :
+ *  Write the cached catalog information through to the catalog page.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_WriteCatalogEntry(
+    ObjectID		*catObjForFile,	/* IN catalog object of the data file */
+    sm_CatOverlayForData *catEntry)	/* IN cached catalog information */
+{
+    Four		e;		/* error number */
+    PageID		catPid;		/* page holding the catalog object */
+    SlottedPage		*catPage;	/* buffer holding the catalog page */
+    sm_CatOverlayForData *onPage;	/* catalog information on the page */
+
+
+    MAKE_PAGEID(catPid, catObjForFile->volNo, catObjForFile->pageNo);
+    e = BfM_GetTrain(&catPid, (char **)&catPage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    GET_PTR_TO_CATENTRY_FOR_DATA(catObjForFile, catPage, onPage);
+    *onPage = *catEntry;
+
+    e = eduom_SetDirty(&catPid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &catPid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&catPid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* eduom_WriteCatalogEntry() */
+
+
+
+/*@================================
+ * eduom_RefreshCatalogEntry()
+ *================================*/
+/*
+ * Function: Four eduom_RefreshCatalogEntry(ObjectID*, sm_CatOverlayForData*)
+ *
+ * Description :
+ *  Read the catalog information from the catalog page into the given copy.
+ *  This is used after calling the lower level routines which update the
+ *  catalog page directly, e.g. om_FileMapAddPage().
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_RefreshCatalogEntry(
+    ObjectID		*catObjForFile,	/* IN catalog object of the data file */
+    sm_CatOverlayForData *catEntry)	/* OUT copy of the catalog information */
+{
+    Four		e;		/* error number */
+    PageID		catPid;		/* page holding the catalog object */
+    SlottedPage		*catPage;	/* buffer holding the catalog page */
+    sm_CatOverlayForData *onPage;	/* catalog information on the page */
+
+
+    MAKE_PAGEID(catPid, catObjForFile->volNo, catObjForFile->pageNo);
+    e = BfM_GetTrain(&catPid, (char **)&catPage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    GET_PTR_TO_CATENTRY_FOR_DATA(catObjForFile, catPage, onPage);
+    *catEntry = *onPage;
+
+    e = BfM_FreeTrain(&catPid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* eduom_RefreshCatalogEntry() */
+
+
+
+/*@================================
+ * EduOM_InvalidateCatalogCache()
+ *================================*/
+/*
+ * Function: Four EduOM_InvalidateCatalogCache(ObjectID*)
+ *
+ * Description :
+ *  Discard the cached catalog information of the data file. This must be
+ *  called when the data file is changed by other than EduOM; the module
+ *  description lists the operations.
+ *  If 'catObjForFile' is NULL, the whole cache is discarded.
+ *  The free space map of the file is discarded as well, and the pages
+ *  preallocated for the file are forgotten.
+ *
+ * Returns:
+ *  error code
+ *    eNOERROR
+ */
+Four EduOM_InvalidateCatalogCache(
+    ObjectID		*catObjForFile)	/* IN catalog object of the data file */
+{
+    Four		i;		/* index variable */
+
+
+    for (i = 0; i < EDUOM_CATCACHE_SIZE; i++)
+        if (catObjForFile == NULL ||
+            EQUAL_OBJECTID(eduom_catCache[i].catObjForFile, *catObjForFile))
+            eduom_catCache[i].valid = FALSE;
+
+    eduom_DropFreeSpaceMap(catObjForFile);
+    eduom_DropPreallocatedPages(catObjForFile);
+
+    return(eNOERROR);
+
+} /* EduOM_InvalidateCatalogCache() */
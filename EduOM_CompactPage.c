@@ -84,122 +84,51 @@ Four EduOM_CompactPage(
     Object *obj;		/* pointer to the object in the data area */
     Two    apageDataOffset;	/* where the next object is to be moved */
     Four   len;			/* length of object + length of ObjectHdr */
-    Two    lastSlot;		/* last non empty slot */
     Two    i;			/* index variable */
-    Four   datalen;
-    Two    originOffset;
-    Object *originObj;
-    Object *prevObj;
-    Two prevOffset;
-    Two prevLength;
-    Two myNewOffset;
-    Object *me;
-    
-    
-    apageDataOffset=0;
-    len=0;
-
-    //파라미터로 주어진 slotNo가 NIL(-1)이 아닌 경우
-    if(slotNo!=NIL){
-        //slotNo에 대응하는 object를 제외한 page의 모든 object들을 데이터 영역의 가장 앞부분부터 연속되게 저장함
-        //i를 0부터 apage의 nSlot만큼 돌면서 앞 object의 마지막 부분으로 offset을 설정함.
-        //앞 object의 마지막 부분 = sizeof(ObjectHdr) + alignedLen = len 
-        for(i=0;i<apage->header.nSlots;i++){
-            if(i!=slotNo){
-                apage->slot[-i].offset=apageDataOffset + len;
-                obj=apage->data[apage->slot[-i].offset];
-                if(obj->header.length%4==0)
-                    datalen=obj->header.length;
-                else if(obj->header.length%4==1)
-                    datalen=obj->header.length+3;
-                else if(obj->header.length%4==2)
-                    datalen=obj->header.length+2;
-                else if(obj->header.length%4==3)
-                    datalen=obj->header.length+1;
-                len=sizeof(ObjectHdr)+datalen;
-                apageDataOffset=apage->slot[-i].offset;
-            }
-            else{
-                continue;
-            }
-            
-        }
-        //slotNo에 대응하는 object를 데이터 영역 상에서의 마지막 object로 저장함
-        apage->slot[-slotNo].offset=apageDataOffset+len;
-    }
-    
-    else{
-        // 파라미터로 주어진 slotNo가 NIL(-1)인 경우
-        // page의 모든 object들을 데이터 영역의 가장 앞부분부터 연속되게 저장함
-        for(i=0;i<apage->header.nSlots;i++){
-            if(apage->slot[-i].offset==EMPTYSLOT){
-                // printf("skip %d\n",i);
-                continue;
-            }
-            // originOffset=apage->slot[-i].offset;
-            // apage->slot[-i].offset=apageDataOffset + len;
-            // // obj = (Object *)&(apage->data[apage->slot[-i].offset]);
-            // // originObj = (Object *)&(apage->data[originOffset]);
-            // obj = (Object *)&(apage->data[originOffset]);
-            
-
-            // Four tempOffset;
-            // obj = (Object *)&(apage->data[apage->slot[-i].offset]);
-            // tempOffset=apageDataOffset + len;
-            // apage->data[tempOffset]=obj;
-            // apage->slot[-i].offset=tempOffset;
-            originOffset=apage->slot[-i].offset;
-            apage->slot[-i].offset=apageDataOffset + len;
-            // obj = (Object *)&(apage->data[apage->slot[-i].offset]);
-            originObj = (Object *)&(apage->data[originOffset]);
-            obj = (Object *)&(apage->data[apage->slot[-i].offset]);
-            obj->header=originObj->header;
-            memcpy(obj->data, originObj->data, originObj->header.length);
-            // apage->slot[-i].offset=apageDataOffset+len;
-            // apage->data[apage->slot[-i].offset] = obj;
-            // printf("%d  ",i);
-            // printf("%d  ", apageDataOffset+len);
-            // printf("%s\n",apage->data[apage->slot[-i].offset]);
-            if(obj->header.length%4==0)
-                datalen=obj->header.length;
-            else if(obj->header.length%4==1)
-                datalen=obj->header.length+3;
-            else if(obj->header.length%4==2)
-                datalen=obj->header.length+2;
-            else if(obj->header.length%4==3)
-                datalen=obj->header.length+1;
-            len=sizeof(ObjectHdr)+datalen;
-            // memcpy(obj, originObj, len);
-            apageDataOffset=apage->slot[-i].offset;
-        }
-        // for(i=0;i<apage->header.nSlots;i++){
-        //     if(apage->slot[-i].offset==EMPTYSLOT){
-        //         continue;
-        //     }
-        //     if(i!=0){
-        //         prevOffset = apage->data[apage->slot[-(i-1)].offset];
-        //         prevObj = (Object *)&(prevOffset);
-        //         if(prevObj->header.length%4==0)
-        //             prevLength=prevObj->header.length;
-        //         else if(prevObj->header.length%4==1)
-        //             prevLength=prevObj->header.length+3;
-        //         else if(prevObj->header.length%4==2)
-        //             prevLength=prevObj->header.length+2;
-        //         else if(prevObj->header.length%4==3)
-        //             prevLength=prevObj->header.length+1;
-        //         me = (Object *)&(apage->data[apage->slot[-i].offset]);
-        //         myNewOffset=prevOffset+prevLength;
-        //         apage->data[myNewOffset] = me;
-
-        //         apage->slot[-i].offset=myNewOffset;
-        //     }
-        // }
+
+
+    eduom_stat.nCompactPage++;
+
+#ifdef EDUOM_PIN_DEBUG
+    /* the pointers given by EduOM_PinObject() into this page become stale */
+    if (eduom_IsPinnedPage(&(apage->header.pid)))
+        Util_ErrorLog_Printf("Pin conflict : page (%d, %d) is compacted while pinned\n",
+                             apage->header.pid.volNo, apage->header.pid.pageNo);
+#endif /* EDUOM_PIN_DEBUG */
+
+    /*@ save the data area of the given page into the temporary page */
+    /* Objects are not ordered by the slot number in the data area, so they
+     * are copied from the saved image to avoid overwriting live objects. */
+    memcpy(tpage.data, apage->data, apage->header.free);
+
+    apageDataOffset = 0;
+
+    for (i = 0; i < apage->header.nSlots; i++) {
+
+        if (apage->slot[-i].offset == EMPTYSLOT || i == slotNo) continue;
+
+        obj = (Object *)&(tpage.data[apage->slot[-i].offset]);
+        len = OBJ_RECORD_SIZE(obj);
+
+        memcpy(&(apage->data[apageDataOffset]), obj, len);
+        apage->slot[-i].offset = apageDataOffset;
+        apageDataOffset += len;
     }
 
+    /*@ the object of 'slotNo' goes to the end of the data area */
+    if (slotNo != NIL && apage->slot[-slotNo].offset != EMPTYSLOT) {
+
+        obj = (Object *)&(tpage.data[apage->slot[-slotNo].offset]);
+        len = OBJ_RECORD_SIZE(obj);
+
+        memcpy(&(apage->data[apageDataOffset]), obj, len);
+        apage->slot[-slotNo].offset = apageDataOffset;
+        apageDataOffset += len;
+    }
 
-    //pageheader를 갱신함
-    apage->header.free = apageDataOffset + len;
-    apage->header.unused=0;
+    /*@ update the page header */
+    apage->header.free = apageDataOffset;
+    apage->header.unused = 0;
 
     return(eNOERROR);
     
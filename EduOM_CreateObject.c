@@ -30,14 +30,118 @@
  *
  * Exports:
  *  Four EduOM_CreateObject(ObjectID*, ObjectID*, ObjectHdr*, Four, char*, ObjectID*)
+ *
+ * Internal Exports:
+ *  Four eduom_CreateObject(ObjectID*, ObjectID*, ObjectHdr*, Four, char*, ObjectID*)
+ *  Four eduom_GetPageForInsert(ObjectID*, ObjectID*, Four, PageID*, SlottedPage**)
+ *  Four eduom_AllocPageAfter(ObjectID*, PageID*, PageID*, SlottedPage**)
+ *  Four eduom_InitSlottedPage(SlottedPage*, PageID*, FileID*)
+ *  Four eduom_GetUnique(SlottedPage*, Unique*)
+ *  Four eduom_InsertInPage(SlottedPage*, ObjectHdr*, Four, char*, ObjectID*)
  */
 
 #include <string.h>
 #include "EduOM_common.h"
+#include "EduOM.h"		/* for the EduOM interface call */
 #include "RDsM.h"		/* for the raw disk manager call */
 #include "BfM.h"		/* for the buffer manager call */
+#include "Util.h"		/* to get Pool */
 #include "EduOM_Internal.h"
 
+/*@================================
+ * eduom_FreeDeallocList()
+ *================================*/
+/*
+ * Function: static Four eduom_FreeDeallocList(DeallocListElem*, ObjectID*, Boolean)
+ *
+ * Description :
+ *  Free at once the pages and trains put on a local dealloc list and return
+ *  its elements to the pool. DL_TRAIN elements are trains of a large object.
+ *  LOT_DestroyObject() puts the trains of a large object whose root is in
+ *  the slotted page as DL_PAGE elements; so, if 'lotPages' is TRUE and the
+ *  list holds no DL_TRAIN element, every DL_PAGE element other than the page
+ *  of 'oid' is freed as a train.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_FreeDeallocList(
+    DeallocListElem *dlList,	/* INOUT head of the local dealloc list */
+    ObjectID	*oid,		/* IN object whose page may be on the list */
+    Boolean	lotPages)	/* IN TRUE if the list is filled by destroying a large object */
+{
+    Four        e;		/* error number */
+    Two         size;		/* # of pages to free */
+    DeallocListElem *dlElem;	/* element of dealloc list */
+
+
+    for (dlElem = dlList->next; dlElem != NULL; dlElem = dlElem->next)
+        if (dlElem->type == DL_TRAIN) lotPages = FALSE;
+
+    for (e = eNOERROR; (dlElem = dlList->next) != NULL; ) {
+        if (dlElem->type == DL_TRAIN)
+            size = TRAINSIZE2;
+        else if (lotPages &&
+                 !(dlElem->elem.pid.volNo == oid->volNo && dlElem->elem.pid.pageNo == oid->pageNo))
+            size = TRAINSIZE2;
+        else
+            size = PAGESIZE2;
+
+        if (dlElem->type != DL_FILE && e >= 0)
+            e = RDsM_FreeTrain(&(dlElem->elem.pid), size);
+
+        dlList->next = dlElem->next;
+        (Four) Util_freeElementToPool(&dlPool, dlElem);
+    }
+
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* eduom_FreeDeallocList() */
+
+
+
+/*@================================
+ * eduom_DiscardObject()
+ *================================*/
+/*
+ * Function: static Four eduom_DiscardObject(ObjectID*, ObjectID*)
+ *
+ * Description :
+ *  Destroy an object whose creation failed. Nobody has seen the object, so
+ *  its page, if the object was its only one, and the trains of a large
+ *  object are freed at once instead of being left on the dealloc list.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_DiscardObject(
+    ObjectID	*catObjForFile,	/* IN file containing the object */
+    ObjectID	*oid)		/* IN object to destroy */
+{
+    Four        e;		/* error number */
+    Four        eFree;		/* error number of freeing the pages */
+    DeallocListElem dlLocal;	/* head of the pages freed by the destroy */
+
+
+    dlLocal.next = NULL;
+
+    e = EduOM_DestroyObject(catObjForFile, oid, &dlPool, &dlLocal);
+
+    eFree = eduom_FreeDeallocList(&dlLocal, oid, TRUE);
+
+    if (e < 0) ERR(e);
+    if (eFree < 0) ERR(eFree);
+
+    return(eNOERROR);
+
+} /* eduom_DiscardObject() */
+
+
+
 /*@================================
  * EduOM_CreateObject()
  *================================*/
@@ -53,6 +157,8 @@
  * If there is no room in the page holding the specified object,
  * it trys to insert into the page in the available space list. If fail, then
  * the new object will be put into the newly allocated page.
+ * An object longer than LRGOBJ_THRESHOLD is created as a large object
+ * with the P_LRGOBJ property, whose data are kept by the large object manager.
  *
  * (2) How to do?
  *	a. Read in the near slotted page
@@ -90,7 +196,11 @@ Four EduOM_CreateObject(
     ObjectID  *oid)		/* OUT the object's ObjectID */
 {
     Four        e;		/* error number */
+    Four        eFree;		/* error number of freeing the pages */
+    Four        done;		/* # of bytes of a large object written */
+    Four        n;		/* # of bytes appended by a call */
     ObjectHdr   objectHdr;	/* ObjectHdr with tag set from parameter */
+    DeallocListElem dlLocal;	/* head of the pages freed by the conversion */
 
 
     /*@ parameter checking */
@@ -101,8 +211,6 @@ Four EduOM_CreateObject(
 
     if (length > 0 && data == NULL) return(eBADUSERBUF_OM);
 
-	/* Error check whether using not supported functionality by EduOM */
-	if(ALIGNED_LENGTH(length) > LRGOBJ_THRESHOLD) ERR(eNOTSUPPORTED_EDUOM);
     objectHdr.properties=0x0;
     objectHdr.length=0;
     objectHdr.tag=0;
@@ -113,12 +221,39 @@ Four EduOM_CreateObject(
     //     objectHdr.tag=0;
     // }
     // else objectHdr.tag=objHdr->tag;
-    eduom_CreateObject(catObjForFile, nearObj, &objectHdr, length, data, oid);
+    /* a large object starts as a small object holding the first bytes of
+     * the data, which is converted into a large object by appending the rest.
+     * The rest is appended a train at a time: the trains allocated by a failed
+     * LOT_AppendToObject() are not in the tree, but those of the earlier calls
+     * are, and eduom_DiscardObject() frees them */
+    if (ALIGNED_LENGTH(length) > LRGOBJ_THRESHOLD) {
+        e = eduom_CreateObject(catObjForFile, nearObj, &objectHdr, LRGOBJ_MIN_LENGTH, data, oid);
+        if (e < 0) ERR(e);
+
+        dlLocal.next = NULL;
+        for (e = eNOERROR, done = LRGOBJ_MIN_LENGTH; e >= 0 && done < length; done += n) {
+            n = MIN(length - done, TRAINSIZE2*PAGESIZE);
+            e = EduOM_AppendToObject(catObjForFile, oid, n, &data[done], &dlPool, &dlLocal);
+        }
+        eFree = eduom_FreeDeallocList(&dlLocal, oid, FALSE);
+        if (e >= 0) e = eFree;
+        if (e < 0) {
+            /* do not leave the first bytes of a large object behind */
+            (Four) eduom_DiscardObject(catObjForFile, oid);
+            ERR(e);
+        }
+
+        return(eNOERROR);
+    }
+
+    e = eduom_CreateObject(catObjForFile, nearObj, &objectHdr, length, data, oid);
+    if (e < 0) ERR(e);
 
     
     return(eNOERROR);
 }
 
+
 /*@================================
  * eduom_CreateObject()
  *================================*/
@@ -159,28 +294,8 @@ Four eduom_CreateObject(
     Four	neededSpace;	/* space needed to put new object [+ header] */
     SlottedPage *apage;		/* pointer to the slotted page buffer */
     Four        alignedLen;	/* aligned length of initial data */
-    Boolean     needToAllocPage;/* Is there a need to alloc a new page? */
     PageID      pid;            /* PageID in which new object to be inserted */
-    PageID      nearPid;
-    Four        firstExt;	/* first Extent No of the file */
-    Object      *obj;		/* point to the newly created object */
-    Two         i;		/* index variable */
-    sm_CatOverlayForData *catEntry; /* pointer to data file catalog information */
-    SlottedPage *catPage;	/* pointer to buffer containing the catalog */
-    FileID      fid;		/* ID of file where the new object is placed */
-    Two         eff;		/* extent fill factor of file */
-    Boolean     isTmp;
-    PhysicalFileID pFid;
-    SlottedPage *objpage;
-    Four contiguouslength;
-    PageID      catpid;
-    PageID      newpid;
-    Unique      newUnique;
-    Boolean     noAvailableSpace = 1;
-    PageID      lastpid;
-    SlottedPage *lastpage;
-    SlotNo      objSlot = NULL;
-    
+    Four        freeSpace;	/* free space of the page before insertion */
     
     
     /*@ parameter checking */
@@ -191,231 +306,483 @@ Four eduom_CreateObject(
     
     /* Error check whether using not supported functionality by EduOM */
     if(ALIGNED_LENGTH(length) > LRGOBJ_THRESHOLD) ERR(eNOTSUPPORTED_EDUOM);
-    //Object 삽입을 위해 필요한 자유 공간의 크기 계산
-    catpid.pageNo=catObjForFile->pageNo;
-    catpid.volNo=catObjForFile->volNo;
-    e=BfM_GetTrain(&catpid, (char **)&catPage, PAGE_BUF);
-    if (e < 0) ERR(e);
-    GET_PTR_TO_CATENTRY_FOR_DATA(catObjForFile, catPage, catEntry);
-    BfM_FreeTrain(&catpid, PAGE_BUF);
 
-    alignedLen=ALIGNED_LENGTH(length);
+    alignedLen = ALIGNED_LENGTH(length);
     neededSpace = sizeof(ObjectHdr) + alignedLen + sizeof(SlottedPageSlot);
 
-    pid.pageNo=catEntry->firstPage;
-    pid.volNo=catEntry->fid.volNo;
+    /*@ select the page into which the object is inserted */
+    e = eduom_GetPageForInsert(catObjForFile, nearObj, neededSpace, &pid, &apage);
+    if (e < 0) ERR(e);
+
+    freeSpace = SP_FREE(apage);
+
+    /*@ put the object into the selected page */
+    e = eduom_InsertInPage(apage, objHdr, length, data, oid);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    /*@ move the page to the proper available space list */
+    e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = eduom_SetDirty(&pid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
     
-    // e=BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+} /* eduom_CreateObject() */
+
+
+
+/*@================================
+ * eduom_FixMappedPage()
+ *================================*/
+/*
+ * Function: static Four eduom_FixMappedPage(ObjectID*, FileID*, PageNo, Four, PageID*, SlottedPage**, Boolean*)
+ *
+ * Description :
+ *  Fix a page taken from the free space map and check that it still
+ *  belongs to the file and has 'neededSpace' bytes of free space. If so,
+ *  the page is compacted if needed and left fixed in the buffer;
+ *  otherwise the map entry of the page is corrected and the page is freed.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter found
+ *     'found' is set to TRUE if the page is usable
+ */
+static Four eduom_FixMappedPage(
+    ObjectID	*catObjForFile,	/* IN catalog object of the data file */
+    FileID	*fid,		/* IN file id of the data file */
+    PageNo	pageNo,		/* IN page taken from the free space map */
+    Four	neededSpace,	/* IN space needed to put new object [+ header] */
+    PageID	*pid,		/* OUT PageID of the page */
+    SlottedPage	**apage,	/* OUT buffer holding the page */
+    Boolean	*found)		/* OUT TRUE if the page has enough room */
+{
+    Four        e;		/* error number */
+
+
+    *found = FALSE;
+
+    MAKE_PAGEID(*pid, fid->volNo, pageNo);
+    e = BfM_GetTrain(pid, (char **)apage, PAGE_BUF);
     if (e < 0) ERR(e);
-    //Object를 삽입할 page를 선정
-    if(nearObj!=NULL){
-    //파라미터로 주어진 nearObj가 NULL이 아닌 경우
-        pid.pageNo=nearObj->pageNo;
-        pid.volNo=nearObj->volNo;
-        e=BfM_GetTrain(&pid,(char **)&apage, PAGE_BUF);//apage: nearObj가 들어있는 page
-        if (e < 0) ERR(e);
-        e = EduOM_CompactPage(apage, NIL);
-            if (e < 0) ERR(e);
-        if(SP_CFREE(apage)>=neededSpace){
-            //nearObj가 저장된 page에 여유 공간이 있는 경우(needed space만큼의 공간이 있는 경우)
-            //해당 page를 object를 삽입할 page로 선정함
-            // objpage=apage;
-            //선정된 page를 현재 available space list에서 삭제함
-            e=om_RemoveFromAvailSpaceList(catObjForFile, &pid, apage);
-            if (e < 0) ERR(e);
-        }
-        else{
-            //nearObj가 저장된 page에 여유 공간이 없는 경우
-            //새로운 page를 할당 받아 object를 삽입할 page로 선정함
-            //printf("1\n");
-            eff=catEntry->eff;
-            e=RDsM_PageIdToExtNo(&pid, &firstExt);
-            if (e < 0) ERR(e);
-            // pid.pageNo = nearObj->pageNo;
-            // pid.volNo = nearObj->volNo;
-            e=RDsM_AllocTrains(nearObj->volNo, firstExt, &pid, eff, 1, 1, &newpid);
-            //printf("1\n");
-            if (e < 0) ERR(e);
-            e=BfM_GetTrain(&newpid, (char **)&apage, PAGE_BUF);
-            //printf("1\n");
-            if (e < 0) ERR(e);
-            //선정된 page의 header를 초기화함->뭘..?
-            apage->header.fid=catEntry->fid;
-            // objpage->header.flags=2;
-            apage->header.free=0;
-            apage->header.nextPage=-1;
-            apage->header.nSlots=0;
-            apage->header.pid=newpid;
-            apage->header.prevPage=nearObj->pageNo;
-            // objpage->header.prevPage=-1;
-            // apage->header.reserved=0;
-            apage->header.spaceListNext=-1;
-            apage->header.spaceListPrev=-1;
-            apage->header.unused=0;
-            apage->header.unique=0;
-            apage->header.uniqueLimit=0;
-            apage->slot[0].offset=EMPTYSLOT;
-            SET_PAGE_TYPE(apage, SLOTTED_PAGE_TYPE);
-            //선정된 page를 file 구성 page들로 이루어진 list에서 nearObj가 저장된 page의 다음 page로 삽입함
-            e=om_FileMapAddPage(catObjForFile, &pid, &newpid);
-            //printf("1\n");
-            if (e < 0) ERR(e);
-            BfM_FreeTrain(&newpid, PAGE_BUF);
+
+    if (EQUAL_FILEID((*apage)->header.fid, *fid) && SP_FREE(*apage) >= neededSpace) {
+        if (SP_CFREE(*apage) < neededSpace) {
+            e = EduOM_CompactPage(*apage, NIL);
+            if (e < 0) ERRB1(e, pid, PAGE_BUF);
         }
-        BfM_FreeTrain(&pid, PAGE_BUF);
+
+        *found = TRUE;
+
+        return(eNOERROR);
     }
 
-    else{
-        // newpid.pageNo = catEntry->lastPage;
-        //     newpid.volNo = catEntry->fid.volNo;
-        //     e=BfM_GetTrain(&newpid,(char **)&objpage, PAGE_BUF);
-        //파라미터로 주어진 nearObj가 NULL인 경우
-        //Object 삽입을 위해 필요한 자유 공간의 크기에 알맞은 available space list가 존재하는 경우
-            //printf("2\n");
-        if(neededSpace<SP_20SIZE){
-            if(catEntry->availSpaceList10!=-1){
-                noAvailableSpace = 0;
-                newpid.pageNo=catEntry->availSpaceList10;
-            }
-        }
-        if(neededSpace<SP_30SIZE && noAvailableSpace){
-            if(catEntry->availSpaceList20!=-1){
-                noAvailableSpace = 0;
-                newpid.pageNo=catEntry->availSpaceList20;
-            }
-        }
-        if(neededSpace<SP_40SIZE && noAvailableSpace){
-            if(catEntry->availSpaceList30!=-1){
-                noAvailableSpace = 0;
-                newpid.pageNo=catEntry->availSpaceList30;
-            }
-        }
-        if(neededSpace<SP_50SIZE && noAvailableSpace){
-            if(catEntry->availSpaceList40!=-1){
-                noAvailableSpace = 0;
-                newpid.pageNo=catEntry->availSpaceList40;
-            }
-        }
-        if(noAvailableSpace){
-            if(catEntry->availSpaceList50!=-1){
-                noAvailableSpace = 0;
-                newpid.pageNo=catEntry->availSpaceList50;
+    /* the map is out of date; correct it */
+    if (EQUAL_FILEID((*apage)->header.fid, *fid))
+        e = eduom_SetFreeSpaceMap(catObjForFile, pid, SP_FREE(*apage));
+    else
+        e = eduom_ClearFreeSpaceMap(catObjForFile, pid);
+    if (e < 0) ERRB1(e, pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* eduom_FixMappedPage() */
+
+
+
+/*@================================
+ * eduom_GetPageForInsert()
+ *================================*/
+/*
+ * Function: Four eduom_GetPageForInsert(ObjectID*, ObjectID*, Four, PageID*, SlottedPage**)
+ *
+ * Description :
+ *  Select the page into which a new object of 'neededSpace' bytes
+ *  (object header + aligned data + one slot) is inserted.
+ *  The selected page is returned fixed in the buffer with at least
+ *  'neededSpace' contiguous free bytes. The page is left in the available
+ *  space list of its current free space; the caller must move it with
+ *  eduom_UpdateAvailSpaceList() after the insertion, set it dirty and free it.
+ *
+ *  a. IF 'nearObj' is not NULL THEN
+ *         use the near page if it has enough room,
+ *         otherwise use the best fit page in the extent of the near page,
+ *         otherwise allocate a new page after the near page
+ *  b. ELSE
+ *         use the best fit page in the free space map if any,
+ *         otherwise use the last page of the file if it has enough room,
+ *         otherwise allocate a new page after the last page
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter pid
+ *     'pid' is set to the PageID of the selected page
+ *  2) parameter apage
+ *     'apage' points to the buffer holding the selected page
+ */
+Four eduom_GetPageForInsert(
+    ObjectID	*catObjForFile,	/* IN file in which object is to be placed */
+    ObjectID	*nearObj,	/* IN create the new object near this object */
+    Four	neededSpace,	/* IN space needed to put new object [+ header] */
+    PageID	*pid,		/* OUT page selected for the insertion */
+    SlottedPage	**apage)	/* OUT buffer holding the selected page */
+{
+    Four        e;		/* error number */
+    PageID      nearPid;	/* page holding the near object */
+    PageID      lastPid;	/* last page of the file */
+    SlottedPage *nearPage;	/* buffer holding the near page */
+    SlottedPage *lastPage;	/* buffer holding the last page */
+    PageNo      availPage;	/* page taken from the free space map */
+    ObjectID    nearLoc;	/* record holding the data of the near object */
+    PageID      extPid;		/* first page of the extent of the near page */
+    Four        extNo;		/* extent of the near page */
+    Two         sizeOfExt;	/* # of pages in an extent */
+    Boolean     found;		/* TRUE if a mapped page has enough room */
+    sm_CatOverlayForData *catEntry; /* cached catalog information of the file */
+
+
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) ERR(e);
+
+    if (nearObj != NULL) {
+
+        MAKE_PAGEID(nearPid, nearObj->volNo, nearObj->pageNo);
+        e = BfM_GetTrain(&nearPid, (char **)&nearPage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        /* a moved object is near its forwarded record, not its stub */
+        e = eduom_FollowForwarding(nearObj, &nearPid, &nearPage, &nearLoc);
+        if (e < 0) ERR(e);
+
+        if (SP_FREE(nearPage) >= neededSpace) {
+            /* the near page has enough room; compact it only if needed */
+            if (SP_CFREE(nearPage) < neededSpace) {
+                e = EduOM_CompactPage(nearPage, NIL);
+                if (e < 0) ERRB1(e, &nearPid, PAGE_BUF);
             }
+
+            *pid = nearPid;
+            *apage = nearPage;
+
+            return(eNOERROR);
         }
-        newpid.volNo=catObjForFile->volNo;
-        BfM_GetTrain(&newpid,(char **)&apage, PAGE_BUF);
-        om_RemoveFromAvailSpaceList(catObjForFile, &newpid, apage);
-        //Object 삽입을 위해 필요한 자유 공간의 크기에 알맞은 available space list가 존재하지 않는 경우
-        if(noAvailableSpace){
-            lastpid.pageNo=catEntry->lastPage;
-            lastpid.volNo=catObjForFile->volNo;
-            e=BfM_GetTrain(&lastpid, (char **)lastpage, PAGE_BUF);
-            if (e < 0) ERR(e);
-            e=EduOM_CompactPage(lastpage, NIL);
-            if (e < 0) ERR(e);
-            //file의 마지막 page에 여유 공간이 있는 경우
-            if(SP_CFREE(lastpage)>=neededSpace){
-                //File의 마지막 page를 object를 삽입할 page로 선정함
-                apage=lastpage;
-                om_RemoveFromAvailSpaceList(catObjForFile, &newpid, apage);
+
+        /*@ find the best fit page in the extent of the near page */
+        e = RDsM_GetSizeOfExt(nearPid.volNo, &sizeOfExt);
+        if (e < 0) ERRB1(e, &nearPid, PAGE_BUF);
+
+        e = RDsM_PageIdToExtNo(&nearPid, &extNo);
+        if (e < 0) ERRB1(e, &nearPid, PAGE_BUF);
+
+        e = RDsM_ExtNoToPageId(nearPid.volNo, extNo, &extPid);
+        if (e < 0) ERRB1(e, &nearPid, PAGE_BUF);
+
+        for ( ; ; ) {
+            e = eduom_FindPageInFreeSpaceMapRange(catObjForFile, neededSpace,
+                                                  extPid.pageNo, sizeOfExt, &availPage);
+            if (e < 0) ERRB1(e, &nearPid, PAGE_BUF);
+
+            if (availPage == NIL) break;
+
+            if (availPage == nearPid.pageNo) {
+                /* the near page has no room; correct its entry and look on */
+                e = eduom_SetFreeSpaceMap(catObjForFile, &nearPid, SP_FREE(nearPage));
+                if (e < 0) ERRB1(e, &nearPid, PAGE_BUF);
+
+                continue;
             }
-            //file의 마지막 page에 여유 공간이 없는 경우
-            else{
-                //새로운 page를 할당 받아 object를 삽입할 page로 선정함->get new train 써야하나?
-                eff=catEntry->eff;
-                e=RDsM_PageIdToExtNo(&lastpid, &firstExt);
-                if (e < 0) ERR(e);
-                e=RDsM_AllocTrains(lastpid.volNo, firstExt, &lastpid, eff, 1, 1, &newpid);
-                if (e < 0) ERR(e);
-                // BfM_GetNewTrain()
-                //선정된 page의 header를 초기화함
-                apage->header.fid=catEntry->fid;
-                // objpage->header.flags=2;
-                apage->header.free=0;
-                apage->header.nextPage=-1;
-                apage->header.nSlots=0;
-                apage->header.pid=newpid;
-                apage->header.prevPage=nearObj->pageNo;
-                // objpage->header.prevPage=-1;
-                // apage->header.reserved=0;
-                apage->header.spaceListNext=-1;
-                apage->header.spaceListPrev=-1;
-                apage->header.unused=0;
-                apage->header.unique=0;
-                apage->header.uniqueLimit=0;
-                apage->slot[0].offset=EMPTYSLOT;
-                SET_PAGE_TYPE(apage, SLOTTED_PAGE_TYPE);
-                //선정된 page를 file의 구성 page들로 이루어진 list에서 마지막 page로 삽입함
-                e=om_FileMapAddPage(catObjForFile, &lastpid, &newpid);
-                if (e < 0) ERR(e);
+
+            e = eduom_FixMappedPage(catObjForFile, &catEntry->fid, availPage, neededSpace, pid, apage, &found);
+            if (e < 0) ERRB1(e, &nearPid, PAGE_BUF);
+
+            if (found) {
+                e = BfM_FreeTrain(&nearPid, PAGE_BUF);
+                if (e < 0) ERRB1(e, pid, PAGE_BUF);
+
+                return(eNOERROR);
             }
-            BfM_FreeTrain(&lastpid, PAGE_BUF);
-        }
-    }
-            //printf("1\n");
-    //선정된 page에 object를 삽입함
-    //Object의 header를 갱신함
-    objHdr->length=length;
-    //빈 slot 있는지 검사
-    for(int i=0;i<apage->header.nSlots;i++){
-        if(i!=0 && apage->slot[-i].offset==EMPTYSLOT){
-            objSlot = i;
-            break;
         }
+
+        /* allocate a new page and link it after the near page */
+        e = eduom_AllocPageAfter(catObjForFile, &nearPid, pid, apage);
+        if (e < 0) ERRB1(e, &nearPid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&nearPid, PAGE_BUF);
+        if (e < 0) ERRB1(e, pid, PAGE_BUF);
+
+        return(eNOERROR);
     }
-    //새로운 unique 만듦
-    Unique *newObjUnique;
-    //새로운 object 만들어서 data와 header 입력
-    Object *newObject;
-    //empty page의 nSlot이 초기에 1로 설정되어 있는 문제를 해결하기위한 코드
-    if(apage->slot[0].offset==EMPTYSLOT)
-        apage->header.nSlots=0;
-
-            //printf("1\n");
-    //빈 slot이 있는 경우: 빈 slot에 들어간다
-    if(objSlot!=NULL){
-        e=om_GetUnique(&(apage->header.pid), &(apage->slot[-objSlot].unique));
-            //printf("1\n");
+
+    /*@ find the best fit page in the free space map */
+    for ( ; ; ) {
+        e = eduom_FindPageInFreeSpaceMap(catObjForFile, neededSpace, &availPage);
         if (e < 0) ERR(e);
-        // objpage->slot[-objSlot].unique=*newObjUnique;
-        apage->slot[-objSlot].offset=apage->header.free;
-        oid->slotNo=objSlot;
-    }
-    //빈 slot이 없는 경우: 새로운 slot을 만든다
-    //nslots는 처음에 1로 설정되어있다. 왜..?
-    else if(objSlot==NULL){
-        apage->header.nSlots++;
-        oid->slotNo=apage->header.nSlots-1;
-        apage->slot[-oid->slotNo].offset=apage->header.free;
-        e=om_GetUnique(&(apage->header.pid), &(apage->slot[-(oid->slotNo)].unique));
+
+        if (availPage == NIL) break;
+
+        e = eduom_FixMappedPage(catObjForFile, &catEntry->fid, availPage, neededSpace, pid, apage, &found);
         if (e < 0) ERR(e);
+
+        if (found) return(eNOERROR);
     }
-    // objpage->header.free=&newObject;
-    newObject = (Object *)&(apage->data[apage->slot[-oid->slotNo].offset]);
-    for(int i=0;i<length;i++){
-        // objpage->data[objpage->slot[-(oid->slotNo)].offset+sizeof(ObjectHdr)+i]=data[i];
-        newObject->data[i]=data[i];
+
+    /*@ try the last page of the file */
+    MAKE_PAGEID(lastPid, catEntry->fid.volNo, catEntry->lastPage);
+    e = BfM_GetTrain(&lastPid, (char **)&lastPage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    if (SP_FREE(lastPage) >= neededSpace) {
+        if (SP_CFREE(lastPage) < neededSpace) {
+            e = EduOM_CompactPage(lastPage, NIL);
+            if (e < 0) ERRB1(e, &lastPid, PAGE_BUF);
+        }
+
+        *pid = lastPid;
+        *apage = lastPage;
+
+        return(eNOERROR);
     }
-    for(int i=length;i<alignedLen;i++){
-        // objpage->data[objpage->slot[-(oid->slotNo)].offset+sizeof(ObjectHdr)+i]=NULL;
-        newObject->data[i]=NULL;
+
+    /* allocate a new page and append it at the tail of the file */
+    e = eduom_AllocPageAfter(catObjForFile, &lastPid, pid, apage);
+    if (e < 0) ERRB1(e, &lastPid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&lastPid, PAGE_BUF);
+    if (e < 0) ERRB1(e, pid, PAGE_BUF);
+
+    return(eNOERROR);
+
+} /* eduom_GetPageForInsert() */
+
+
+
+/*@================================
+ * eduom_AllocPageAfter()
+ *================================*/
+/*
+ * Function: Four eduom_AllocPageAfter(ObjectID*, PageID*, PageID*, SlottedPage**)
+ *
+ * Description :
+ *  Allocate a new page in the file, initialize it as an empty slotted page
+ *  and insert it after the page 'prevPid' in the list of pages consisting
+ *  in the file. The new page is put into the available space list and
+ *  returned fixed in the buffer. The page is not read from the disk since
+ *  it holds no data yet.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter newPid
+ *     'newPid' is set to the PageID of the allocated page
+ *  2) parameter apage
+ *     'apage' points to the buffer holding the allocated page
+ */
+Four eduom_AllocPageAfter(
+    ObjectID	*catObjForFile,	/* IN file in which the page is allocated */
+    PageID	*prevPid,	/* IN the new page is linked after this page */
+    PageID	*newPid,	/* OUT the allocated page */
+    SlottedPage	**apage)	/* OUT buffer holding the allocated page */
+{
+    Four        e;		/* error number */
+    SlottedPage *npage;		/* buffer holding the allocated page */
+    sm_CatOverlayForData *catEntry; /* cached catalog information of the file */
+
+
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) ERR(e);
+
+    e = eduom_AllocPage(catObjForFile, prevPid, newPid);
+    if (e < 0) ERR(e);
+
+    /* the page holds nothing yet; fix a buffer for it without reading it */
+    e = BfM_GetNewTrain(newPid, (char **)&npage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    e = eduom_InitSlottedPage(npage, newPid, &(catEntry->fid));
+    if (e < 0) ERRB1(e, newPid, PAGE_BUF);
+
+    e = eduom_SetDirty(newPid, PAGE_BUF);
+    if (e < 0) ERRB1(e, newPid, PAGE_BUF);
+
+    /*@ insert the page into the list of pages of the file */
+    e = om_FileMapAddPage(catObjForFile, prevPid, newPid);
+    if (e < 0) ERRB1(e, newPid, PAGE_BUF);
+
+    /* om_FileMapAddPage() updates the catalog page directly */
+    e = eduom_RefreshCatalogEntry(catObjForFile, catEntry);
+    if (e < 0) ERRB1(e, newPid, PAGE_BUF);
+
+    e = eduom_PutInAvailSpaceList(catObjForFile, newPid, npage);
+    if (e < 0) ERRB1(e, newPid, PAGE_BUF);
+
+    *apage = npage;
+
+    return(eNOERROR);
+
+} /* eduom_AllocPageAfter() */
+
+
+
+/*@================================
+ * eduom_InitSlottedPage()
+ *================================*/
+/*
+ * Function: Four eduom_InitSlottedPage(SlottedPage*, PageID*, FileID*)
+ *
+ * Description :
+ *  Initialize the given buffer as an empty slotted page of the file.
+ *  The page has one empty slot, which is on the free slot list, and is not
+ *  linked to any other page.
+ *
+ * Returns:
+ *  error code
+ *    eNOERROR
+ */
+Four eduom_InitSlottedPage(
+    SlottedPage	*apage,		/* OUT page to initialize */
+    PageID	*pid,		/* IN page ID of the page */
+    FileID	*fid)		/* IN file to which the page belongs */
+{
+    apage->header.pid = *pid;
+    apage->header.flags = 0x0;
+    SET_PAGE_TYPE(apage, SLOTTED_PAGE_TYPE);
+    apage->header.nSlots = 1;
+    apage->header.free = 0;
+    apage->header.unused = 0;
+    apage->header.fid = *fid;
+    apage->header.unique = 0;
+    apage->header.uniqueLimit = 0;
+    apage->header.nextPage = NIL;
+    apage->header.prevPage = NIL;
+    apage->header.spaceListPrev = NIL;
+    apage->header.spaceListNext = NIL;
+    apage->slot[0].offset = EMPTYSLOT;
+    SP_NEXT_FREESLOT(apage, 0) = (Unique)NIL;
+    SET_SP_FREESLOT_HEAD(apage, 0);
+
+    return(eNOERROR);
+
+} /* eduom_InitSlottedPage() */
+
+
+
+/*@================================
+ * eduom_GetUnique()
+ *================================*/
+/*
+ * Function: Four eduom_GetUnique(SlottedPage*, Unique*)
+ *
+ * Description :
+ *  Return a new unique number for an object in the given page. The unique
+ *  numbers are taken from the range reserved in the page header; a new
+ *  range is reserved from the volume when the range is used up. This is
+ *  the same as om_GetUnique() except that the page need not be in the
+ *  buffer. The caller must set the page dirty.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_GetUnique(
+    SlottedPage	*apage,		/* INOUT page holding the new object */
+    Unique	*unique)	/* OUT new unique number */
+{
+    Four        e;		/* error number */
+    Four        num;		/* # of unique numbers reserved */
+
+
+    if (apage->header.unique >= apage->header.uniqueLimit) {
+        e = RDsM_GetUnique(&(apage->header.pid), unique, &num);
+        if (e < 0) ERR(e);
+
+        apage->header.unique = *unique;
+        apage->header.uniqueLimit = *unique + num;
     }
-    // objpage->data[objpage->slot[-oid->slotNo]]=*objHdr;
-    newObject->header=*objHdr;
-    
-    //page의 header를 갱신함
-    apage->header.free+=sizeof(ObjectHdr)+alignedLen;
-    //page를 알맞은 available space list에 삽입함
-    e=om_PutInAvailSpaceList(catObjForFile, &(apage->header.pid), apage);
+
+    *unique = apage->header.unique++;
+
+    return(eNOERROR);
+
+} /* eduom_GetUnique() */
+
+
+
+/*@================================
+ * eduom_InsertInPage()
+ *================================*/
+/*
+ * Function: Four eduom_InsertInPage(SlottedPage*, ObjectHdr*, Four, char*, ObjectID*)
+ *
+ * Description :
+ *  Put a new object into the given page at the start of the contiguous free
+ *  area. An empty slot is taken off the free slot list if there is any;
+ *  otherwise a new slot is appended to the slot array. The caller must guarantee that the contiguous
+ *  free area is large enough.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter oid
+ *     'oid' is set to the ObjectID of the newly created object.
+ */
+Four eduom_InsertInPage(
+    SlottedPage	*apage,		/* INOUT page into which the object is put */
+    ObjectHdr	*objHdr,	/* IN from which tag & properties are set */
+    Four	length,		/* IN amount of data */
+    char	*data,		/* IN the initial data for the object */
+    ObjectID	*oid)		/* OUT the object's ObjectID */
+{
+    Four        e;		/* error number */
+    Two         i;		/* index variable */
+    Four        alignedLen;	/* aligned length of initial data */
+    Object      *obj;		/* point to the newly created object */
+
+
+    alignedLen = ALIGNED_LENGTH(length);
+
+    /*@ take an empty slot; if there is none, append a new slot */
+    e = eduom_GetFreeSlot(apage, &i);
     if (e < 0) ERR(e);
 
-    //삽입된 object의 ID를 반환함
-    oid->pageNo=apage->header.pid.pageNo;
-    oid->unique=apage->slot[-(oid->slotNo)].unique;
-    oid->volNo=catObjForFile->volNo;
-    BfM_SetDirty(&(apage->header.pid), PAGE_BUF);
-    BfM_FreeTrain(&(apage->header.pid),PAGE_BUF);
+    if (i == NIL) i = apage->header.nSlots++;
+
+    e = eduom_GetUnique(apage, &(apage->slot[-i].unique));
+    if (e < 0) ERR(e);
+
+    /*@ copy the object into the contiguous free area */
+    apage->slot[-i].offset = apage->header.free;
+    obj = (Object *)&(apage->data[apage->header.free]);
+
+    obj->header.properties = objHdr->properties;
+    obj->header.tag = objHdr->tag;
+    obj->header.length = length;
+    if (length > 0) memcpy(obj->data, data, length);
+    if (alignedLen > length) memset(&(obj->data[length]), 0, alignedLen - length);
+
+    apage->header.free += sizeof(ObjectHdr) + alignedLen;
+
+    eduom_stat.nInsert++;
+
+    MAKE_OBJECTID(*oid, apage->header.pid.volNo, apage->header.pid.pageNo, i, apage->slot[-i].unique);
 
     return(eNOERROR);
-    
-} /* eduom_CreateObject() */
+
+} /* eduom_InsertInPage() */
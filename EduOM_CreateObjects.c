@@ -0,0 +1,240 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_CreateObjects.c
+ * 
+ * Description :
+ *  EduOM_CreateObjects() creates a batch of new objects near the specified
+ *  object.
+ *
+ * Exports:
+ *  Four EduOM_CreateObjects(ObjectID*, ObjectID*, Four, ObjectHdr*, Four*, char**, ObjectID*)
+ */
+
+#include "EduOM_common.h"
+#include "EduOM.h"		/* for the EduOM interface call */
+#include "BfM.h"		/* for the buffer manager call */
+#include "EduOM_Internal.h"
+
+/*@================================
+ * eduom_CreateObjects()
+ *================================*/
+/*
+ * Function: static Four eduom_CreateObjects(ObjectID*, ObjectID*, Four, ObjectHdr*, Four*, char**, ObjectID*)
+ *
+ * Description :
+ *  Create the objects as EduOM_CreateObjects() does. The preallocation of
+ *  the new pages is begun and ended by the caller.
+ *
+ * Returns:
+ *  error code
+ *    same as EduOM_CreateObjects()
+ */
+static Four eduom_CreateObjects(
+    ObjectID  *catObjForFile,	/* IN file in which objects are to be placed */
+    ObjectID  *nearObj,		/* IN create the first object near this object */
+    Four      n,		/* IN number of objects to create */
+    ObjectHdr *objHdrs,		/* IN headers from which tags are set (may be NULL) */
+    Four      *lengths,		/* IN amount of data of each object */
+    char      **data,		/* IN the initial data of each object */
+    ObjectID  *oids)		/* OUT the objects' ObjectIDs */
+{
+    Four        e;		/* error number */
+    Four        i;		/* index variable */
+    Four	neededSpace;	/* space needed to put new object [+ header] */
+    Four        freeSpace;	/* free space of the current page when selected */
+    ObjectHdr   objectHdr;	/* ObjectHdr with tag set from parameter */
+    SlottedPage *apage;		/* pointer to the current slotted page buffer */
+    SlottedPage *npage;		/* pointer to the newly allocated page buffer */
+    PageID      pid;		/* current page into which objects are inserted */
+    PageID      newPid;		/* newly allocated page */
+    PageID      lastPid;	/* last page of the file */
+    sm_CatOverlayForData *catEntry; /* cached catalog information of the file */
+
+
+    /*@ parameter checking */
+    
+    if (catObjForFile == NULL) ERR(eBADCATALOGOBJECT_OM);
+
+    if (n < 0) ERR(eBADPARAMETER_OM);
+
+    if (n == 0) return(eNOERROR);
+
+    if (lengths == NULL) ERR(eBADLENGTH_OM);
+
+    if (data == NULL) ERR(eBADUSERBUF_OM);
+
+    if (oids == NULL) ERR(eBADOBJECTID_OM);
+
+    for (i = 0; i < n; i++) {
+        if (lengths[i] < 0) ERR(eBADLENGTH_OM);
+
+        if (lengths[i] > 0 && data[i] == NULL) ERR(eBADUSERBUF_OM);
+
+        /* Error check whether using not supported functionality by EduOM */
+        if (ALIGNED_LENGTH(lengths[i]) > LRGOBJ_THRESHOLD) ERR(eNOTSUPPORTED_EDUOM);
+    }
+
+    objectHdr.properties = P_CLEAR;
+    objectHdr.tag = 0;
+    objectHdr.length = 0;
+
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) ERR(e);
+
+    /*@ select the page for the first object */
+    neededSpace = sizeof(ObjectHdr) + ALIGNED_LENGTH(lengths[0]) + sizeof(SlottedPageSlot);
+    e = eduom_GetPageForInsert(catObjForFile, nearObj, neededSpace, &pid, &apage);
+    if (e < 0) ERR(e);
+
+    freeSpace = SP_FREE(apage);
+
+    for (i = 0; i < n; i++) {
+
+        neededSpace = sizeof(ObjectHdr) + ALIGNED_LENGTH(lengths[i]) + sizeof(SlottedPageSlot);
+
+        if (SP_FREE(apage) < neededSpace) {
+            /* no room in the current page; move on to a new page */
+            if (nearObj == NULL)
+                MAKE_PAGEID(lastPid, catEntry->fid.volNo, catEntry->lastPage);
+            else
+                lastPid = pid;
+
+            e = eduom_AllocPageAfter(catObjForFile, &lastPid, &newPid, &npage);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+            e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+            if (e < 0) { (Four) BfM_FreeTrain(&newPid, PAGE_BUF); ERRB1(e, &pid, PAGE_BUF); }
+
+            e = eduom_SetDirty(&pid, PAGE_BUF);
+            if (e < 0) { (Four) BfM_FreeTrain(&newPid, PAGE_BUF); ERRB1(e, &pid, PAGE_BUF); }
+
+            e = BfM_FreeTrain(&pid, PAGE_BUF);
+            if (e < 0) ERRB1(e, &newPid, PAGE_BUF);
+
+            pid = newPid;
+            apage = npage;
+            freeSpace = SP_FREE(apage);
+
+        } else if (SP_CFREE(apage) < neededSpace) {
+            e = EduOM_CompactPage(apage, NIL);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+        }
+
+        objectHdr.tag = (objHdrs != NULL) ? objHdrs[i].tag : 0;
+
+        e = eduom_InsertInPage(apage, &objectHdr, lengths[i], data[i], &oids[i]);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+    }
+
+    /*@ move the last page to the proper available space list */
+    e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = eduom_SetDirty(&pid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+    
+} /* eduom_CreateObjects() */
+
+
+
+/*@================================
+ * EduOM_CreateObjects()
+ *================================*/
+/*
+ * Function: Four EduOM_CreateObjects(ObjectID*, ObjectID*, Four, ObjectHdr*, Four*, char**, ObjectID*)
+ * 
+ * Description :
+ *  (1) What to do?
+ *  EduOM_CreateObjects() creates 'n' new objects as if EduOM_CreateObject()
+ *  were called for each of them, the i-th object being created near the
+ *  (i-1)-th one. The first object is placed as EduOM_CreateObject() does.
+ *  A page is filled with as many objects as fit before moving to the next
+ *  page, so each data page is fixed, moved to the proper available space
+ *  list and set dirty once per call instead of once per object. The new
+ *  pages of the batch are allocated an extent at a time.
+ *
+ *  (2) How to do?
+ *  a. Check all the parameters
+ *  b. Get the catalog entry from the catalog cache
+ *  c. Select the page for the first object
+ *  d. FOR each object DO
+ *         IF no room in the current page THEN
+ *             Allocate a new page after the current page
+ *             (after the last page of the file if 'nearObj' is NULL)
+ *             Move the current page to the proper 'availSpaceList'
+ *             Free the current page
+ *         ENDIF
+ *         Put the object into the current page
+ *     ENDFOR
+ *  e. Move the current page to the proper 'availSpaceList' and free it
+ *  f. Return
+ *
+ * Returns:
+ *  error code
+ *    eBADCATALOGOBJECT_OM
+ *    eBADPARAMETER_OM
+ *    eBADLENGTH_OM
+ *    eBADUSERBUF_OM
+ *    eBADOBJECTID_OM
+ *    some error codes from the lower level
+ *
+ * Side Effects :
+ *  0) 'n' new objects are created.
+ *  1) parameter oids
+ *     'oids[i]' is set to the ObjectID of the i-th newly created object.
+ */
+Four EduOM_CreateObjects(
+    ObjectID  *catObjForFile,	/* IN file in which objects are to be placed */
+    ObjectID  *nearObj,		/* IN create the first object near this object */
+    Four      n,		/* IN number of objects to create */
+    ObjectHdr *objHdrs,		/* IN headers from which tags are set (may be NULL) */
+    Four      *lengths,		/* IN amount of data of each object */
+    char      **data,		/* IN the initial data of each object */
+    ObjectID  *oids)		/* OUT the objects' ObjectIDs */
+{
+    Four        e;		/* error number */
+    Four        ep;		/* error number of returning the preallocated pages */
+
+
+    if (catObjForFile == NULL) ERR(eBADCATALOGOBJECT_OM);
+
+    /* the new pages of the batch are allocated an extent at a time */
+    eduom_BeginPreallocation(catObjForFile);
+
+    e = eduom_CreateObjects(catObjForFile, nearObj, n, objHdrs, lengths, data, oids);
+
+    ep = eduom_EndPreallocation(catObjForFile);
+    if (e < 0) ERR(e);
+    if (ep < 0) ERR(ep);
+
+    return(eNOERROR);
+
+} /* EduOM_CreateObjects() */
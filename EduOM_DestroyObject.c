@@ -32,7 +32,9 @@
  *  Four EduOM_DestroyObject(ObjectID*, ObjectID*, Pool*, DeallocListElem*)
  */
 
+#include <string.h>
 #include "EduOM_common.h"
+#include "EduOM.h"		/* for the EduOM interface call */
 #include "Util.h"		/* to get Pool */
 #include "RDsM.h"
 #include "BfM.h"		/* for the buffer manager call */
@@ -59,14 +61,16 @@
  *
  *  (2) How to do?
  *  a. Read in the slotted page
- *  b. Remove this page from the 'availSpaceList'
+ *  b. Remember the free space which determines the page's 'availSpaceList'
+ *     IF moved object THEN destroy the forwarded record first
+ *     IF large object THEN destroy the large object tree by LOT
  *  c. Delete the object from the page
  *  d. Update the control information: 'unused', 'freeStart', 'slot offset'
  *  e. IF no more object in this page THEN
- *	   Remove this page from the filemap List
+ *	   Remove this page from the 'availSpaceList' and the filemap List
  *	   Dealloate this page
  *    ELSE
- *	   Put this page into the proper 'availSpaceList'
+ *	   Move this page to the proper 'availSpaceList'
  *    ENDIF
  * f. Return
  *
@@ -96,6 +100,9 @@ Four EduOM_DestroyObject(
     sm_CatOverlayForData *catEntry; /* overlay structure for catalog object access */
     DeallocListElem *dlElem;	/* pointer to element of dealloc list */
     PhysicalFileID pFid;	/* physical ID of file */
+    Four        freeSpace;	/* free space of the page before deletion */
+    ObjectID    fwdOid;		/* forwarded record of a moved object */
+    Boolean     large;		/* TRUE if the object is a large object */
     
     
 
@@ -107,8 +114,8 @@ Four EduOM_DestroyObject(
     pid.pageNo=oid->pageNo;
     pid.volNo=oid->volNo;
     BfM_GetTrain(&pid,(char **)&apage,PAGE_BUF);
-    //삭제할 object가 저장된 page를 현재 available space list에서 삭제함
-    om_RemoveFromAvailSpaceList(catObjForFile, &pid, apage);
+    //page가 속한 available space list는 삭제 전의 free space로 결정됨
+    freeSpace = SP_FREE(apage);
     //삭제할 object에 대응하는 Slot을 찾음
     // for(i=0;i<apage->header.nSlots;i++){
     //     if(apage->slot[-i].unique==oid->unique){
@@ -120,6 +127,20 @@ Four EduOM_DestroyObject(
     //object 시작 포인터 + offset 가 obj
     //alignedLen
     obj = apage->data+offset;
+    //이동된 object이면 forwarded record를 먼저 삭제하고 forwarding stub을 삭제함
+    if (obj->header.properties & P_MOVED) {
+        memcpy(&fwdOid, obj->data, sizeof(ObjectID));
+        e = EduOM_DestroyObject(catObjForFile, &fwdOid, dlPool, dlHead);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+        //forwarded record가 같은 page에 있었을 수 있으므로 free space를 다시 구함
+        freeSpace = SP_FREE(apage);
+    }
+    //large object이면 LOT가 large object tree의 page들과 page 안의 record를 삭제함
+    large = (obj->header.properties & P_LRGOBJ) ? TRUE : FALSE;
+    if (large) {
+        e = LOT_DestroyObject(&pid, oid->slotNo, dlPool, dlHead);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+    }
     alignedLen=ALIGNED_LENGTH(obj->header.length);
     //삭제할 object에 대응하는 slot을 사용하지 않는 빈 slot으로 설정함
     apage->slot[-oid->slotNo].offset=EMPTYSLOT;
@@ -128,21 +149,59 @@ Four EduOM_DestroyObject(
     //-> nSlot-1 = i인가?
     if(apage->header.nSlots-1==oid->slotNo)
     {
+        //마지막 slot 앞의 빈 slot들도 slot array에서 제거함
+        //(그래야 모든 object가 삭제된 page의 nSlots가 0이 됨)
         apage->header.nSlots--;
+        while (apage->header.nSlots > 0 &&
+               apage->slot[-(apage->header.nSlots-1)].offset == EMPTYSLOT)
+            apage->header.nSlots--;
+        //제거된 빈 slot들이 free slot list에 남지 않도록 list를 다시 만듦
+        if (apage->header.nSlots < oid->slotNo) {
+            e = eduom_RebuildFreeSlotList(apage);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+        }
+    }
+    else
+    {
+        //빈 slot을 free slot list에 넣음
+        e = eduom_PutFreeSlot(apage, oid->slotNo);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
     }
     //free를 수정, 혹은 unused를 수정
-    //offset + object size == free이면 free를 offset으로 수정.
-    if(offset+sizeof(ObjectHdr)+alignedLen==apage->header.free){
-        apage->header.free=offset;
+    //large object의 record가 차지하던 공간은 LOT_DestroyObject()가 이미 반환함
+    if(!large){
+        //offset + object size == free이면 free를 offset으로 수정.
+        if(offset+sizeof(ObjectHdr)+alignedLen==apage->header.free){
+            apage->header.free=offset;
+        }
+        //위의 경우 아니면 unused가 커짐.
+        else{
+            apage->header.unused += alignedLen + sizeof(ObjectHdr);
+        }
     }
-    //위의 경우 아니면 unused가 커짐.
-    else{
-        apage->header.unused += alignedLen + sizeof(ObjectHdr);
+    //forwarding stub만 가진 page는 file의 page list와 available space list에 없음
+    //마지막 stub이 삭제되면 page를 deallocate함
+    if (apage->header.flags & SP_STUBPAGE) {
+        if (apage->header.nSlots == 0) {
+            Util_getElementFromPool(dlPool, &dlElem);
+            dlElem->next = dlHead->next;
+            dlElem->elem.pid = pid;
+            dlElem->type = DL_PAGE;
+            dlHead->next = dlElem;
+        }
     }
     //삭제된 object가 page의 유일한 object이고, 해당 page가 file의 첫 번째 page가 아닌 경우
-    if(apage->header.nSlots == 0 && !(apage->header.prevPage == -1)){
-        //page를 file 구성 page들로 이루어진 list에서 삭제함
-        om_FileMapDeletePage(catObjForFile, &pid);
+    else if(apage->header.nSlots == 0 && !(apage->header.prevPage == -1)){
+        //page를 available space list와 file 구성 page들로 이루어진 list에서 삭제함
+        e = eduom_RemoveFromAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+        e = om_FileMapDeletePage(catObjForFile, &pid);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+        //om_FileMapDeletePage()는 catalog page를 직접 갱신함
+        e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+        e = eduom_RefreshCatalogEntry(catObjForFile, catEntry);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
         //해당 page를 deallocate함
         Util_getElementFromPool(dlPool, &dlElem);
         //pFid를 구하려면 해당 page를 포함하는 file을 알아내서 첫번째 page의 pid를 알아야함.
@@ -167,9 +226,10 @@ Four EduOM_DestroyObject(
     }
     //삭제된 object가 page의 유일한 object가 아니거나, 해당 page가 file의 첫번째 page인 경우
     else{
-        om_PutInAvailSpaceList(catObjForFile, &pid, apage);
+        e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
     }
-    BfM_SetDirty(&pid, PAGE_BUF);
+    eduom_SetDirty(&pid, PAGE_BUF);
     BfM_FreeTrain(&pid, PAGE_BUF);
     
     return(eNOERROR);
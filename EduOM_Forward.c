@@ -0,0 +1,438 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_Forward.c
+ * 
+ * Description :
+ *  Move objects between pages keeping their ObjectIDs valid. A moved object
+ *  leaves a forwarding stub in its original slot, and the routines here
+ *  follow the stub to the forwarded record in one hop.
+ *
+ * Internal Exports:
+ *  Four eduom_FollowForwarding(ObjectID*, PageID*, SlottedPage**, ObjectID*)
+ *  Four eduom_FixObject(ObjectID*, PageID*, SlottedPage**, Object**, ObjectID*)
+ *  void eduom_GetLogicalObject(SlottedPage*, Two, ObjectID*, ObjectHdr*)
+ *  Four eduom_RelocateObject(PageID*, SlottedPage*, Two, SlottedPage*, ObjectID*)
+ *  Four eduom_RetargetStub(ObjectID*, ObjectID*)
+ *  Four eduom_ResizeInPage(SlottedPage*, Two, Four)
+ *  Four eduom_RemoveFromPage(SlottedPage*, Two)
+ */
+
+#include <string.h>
+#include "EduOM_common.h"
+#include "EduOM.h"		/* for the EduOM interface call */
+#include "BfM.h"		/* for the buffer manager call */
+#include "EduOM_Internal.h"
+
+
+
+/*@================================
+ * eduom_FollowForwarding()
+ *================================*/
+/*
+ * Function: Four eduom_FollowForwarding(ObjectID*, PageID*, SlottedPage**, ObjectID*)
+ *
+ * Description :
+ *  'apage' is the page of 'oid' fixed in the buffer. If the slot of 'oid'
+ *  holds a forwarding stub, the page is freed and the page of the forwarded
+ *  record is fixed instead.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter pid, apage
+ *     'pid' and 'apage' are set to the page holding the record of the object
+ *  2) parameter loc
+ *     'loc' is set to the ObjectID of the record of the object
+ */
+Four eduom_FollowForwarding(
+    ObjectID	*oid,		/* IN object to locate */
+    PageID	*pid,		/* INOUT page fixed in the buffer */
+    SlottedPage	**apage,	/* INOUT buffer holding the page */
+    ObjectID	*loc)		/* OUT record holding the data of the object */
+{
+    Four        e;		/* error number */
+    Object      *obj;		/* the object in the page */
+
+
+    *loc = *oid;
+
+    if (oid->slotNo < 0 || oid->slotNo >= (*apage)->header.nSlots ||
+        (*apage)->slot[-(oid->slotNo)].offset == EMPTYSLOT) return(eNOERROR);
+
+    obj = (Object *)&((*apage)->data[(*apage)->slot[-(oid->slotNo)].offset]);
+
+    if (!(obj->header.properties & P_MOVED)) return(eNOERROR);
+
+    memcpy(loc, obj->data, sizeof(ObjectID));
+
+    e = BfM_FreeTrain(pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    MAKE_PAGEID(*pid, loc->volNo, loc->pageNo);
+    e = BfM_GetTrain(pid, (char **)apage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* eduom_FollowForwarding() */
+
+
+
+/*@================================
+ * eduom_FixObject()
+ *================================*/
+/*
+ * Function: Four eduom_FixObject(ObjectID*, PageID*, SlottedPage**, Object**, ObjectID*)
+ *
+ * Description :
+ *  Fix the page holding the data of the object 'oid' following its
+ *  forwarding stub if the object has been moved. The caller must free the
+ *  page 'pid'. Use OBJ_DATA() and OBJ_LENGTH() to access the user data.
+ *
+ * Returns:
+ *  error code
+ *    eBADOBJECTID_OM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter pid, apage, obj
+ *     set to the page and the record holding the data of the object
+ *  2) parameter loc
+ *     'loc' is set to the ObjectID of the record if it is not NULL
+ */
+Four eduom_FixObject(
+    ObjectID	*oid,		/* IN object to fix */
+    PageID	*pid,		/* OUT page holding the record */
+    SlottedPage	**apage,	/* OUT buffer holding the page */
+    Object	**obj,		/* OUT record holding the data of the object */
+    ObjectID	*loc)		/* OUT ObjectID of the record */
+{
+    Four        e;		/* error number */
+    ObjectID    rec;		/* record holding the data of the object */
+
+
+    MAKE_PAGEID(*pid, oid->volNo, oid->pageNo);
+    e = BfM_GetTrain(pid, (char **)apage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    if (oid->slotNo < 0 || oid->slotNo >= (*apage)->header.nSlots || !IS_VALID_OBJECTID(oid, (*apage)))
+        ERRB1(eBADOBJECTID_OM, pid, PAGE_BUF);
+
+    e = eduom_FollowForwarding(oid, pid, apage, &rec);
+    if (e < 0) ERR(e);
+
+    if (rec.slotNo < 0 || rec.slotNo >= (*apage)->header.nSlots || !IS_VALID_OBJECTID(&rec, (*apage)))
+        ERRB1(eBADOBJECTID_OM, pid, PAGE_BUF);
+
+    *obj = (Object *)&((*apage)->data[(*apage)->slot[-(rec.slotNo)].offset]);
+    if (loc != NULL) *loc = rec;
+
+    return(eNOERROR);
+
+} /* eduom_FixObject() */
+
+
+
+/*@================================
+ * eduom_GetLogicalObject()
+ *================================*/
+/*
+ * Function: void eduom_GetLogicalObject(SlottedPage*, Two, ObjectID*, ObjectHdr*)
+ *
+ * Description :
+ *  Return the ObjectID and the header of the object stored in the slot
+ *  'slotNo' as the user sees them: a forwarded record is reported with the
+ *  ObjectID of its stub and the length of the user data.
+ *
+ * Side Effects :
+ *  1) parameter oid
+ *     'oid' is set to the ObjectID of the object
+ *  2) parameter objHdr
+ *     'objHdr' is set to the header of the object if it is not NULL
+ */
+void eduom_GetLogicalObject(
+    SlottedPage	*apage,		/* IN page holding the record */
+    Two		slotNo,		/* IN slot of the record */
+    ObjectID	*oid,		/* OUT the object's ObjectID */
+    ObjectHdr	*objHdr)	/* OUT the object's header */
+{
+    Object      *obj;		/* the record in the page */
+
+
+    obj = (Object *)&(apage->data[apage->slot[-slotNo].offset]);
+
+    if (obj->header.properties & P_FORWARDED)
+        memcpy(oid, obj->data, sizeof(ObjectID));
+    else
+        MAKE_OBJECTID(*oid, apage->header.pid.volNo, apage->header.pid.pageNo, slotNo, apage->slot[-slotNo].unique);
+
+    if (objHdr != NULL) {
+        *objHdr = obj->header;
+        objHdr->properties &= ~P_FORWARDED;
+        objHdr->length = OBJ_LENGTH(obj);
+    }
+
+} /* eduom_GetLogicalObject() */
+
+
+
+/*@================================
+ * eduom_RelocateObject()
+ *================================*/
+/*
+ * Function: Four eduom_RelocateObject(PageID*, SlottedPage*, Two, SlottedPage*, ObjectID*)
+ *
+ * Description :
+ *  Move the record in the slot 'slotNo' of the page 'srcPage' into the page
+ *  'dstPage'. An ordinary object becomes a forwarded record and leaves a
+ *  stub in its slot; a forwarded record is moved again and its stub is
+ *  updated, so that a stub always points to the record directly.
+ *
+ *  The caller must guarantee that 'dstPage' has free space for the record
+ *  with its back pointer and a slot, and, when an object shorter than an
+ *  ObjectID is moved, that 'srcPage' has free space to enlarge it into a
+ *  stub. The caller also moves both pages in the available space lists.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter newOid
+ *     'newOid' is set to the ObjectID of the forwarded record
+ */
+Four eduom_RelocateObject(
+    PageID	*srcPid,	/* IN page holding the record */
+    SlottedPage	*srcPage,	/* INOUT buffer holding the page */
+    Two		slotNo,		/* IN slot of the record */
+    SlottedPage	*dstPage,	/* INOUT buffer holding the page */
+    ObjectID	*newOid)	/* OUT the forwarded record */
+{
+    Four        e;		/* error number */
+    Object      *obj;		/* the record in the source page */
+    ObjectHdr   objHdr;		/* header of the forwarded record */
+    ObjectID    stubOid;	/* ObjectID of the stub */
+    Four        length;		/* length of the forwarded record */
+    char        *data;		/* data of the forwarded record */
+    char        buf[PAGESIZE];	/* the record with its back pointer */
+
+
+    obj = (Object *)&(srcPage->data[srcPage->slot[-slotNo].offset]);
+    objHdr = obj->header;
+
+    if (obj->header.properties & P_FORWARDED) {
+        memcpy(&stubOid, obj->data, sizeof(ObjectID));
+        length = obj->header.length;
+        data = obj->data;
+    } else {
+        MAKE_OBJECTID(stubOid, srcPid->volNo, srcPid->pageNo, slotNo, srcPage->slot[-slotNo].unique);
+        memcpy(buf, &stubOid, sizeof(ObjectID));
+        memcpy(&buf[FWD_BACKPTR_LEN], obj->data, obj->header.length);
+        length = obj->header.length + FWD_BACKPTR_LEN;
+        data = buf;
+        objHdr.properties |= P_FORWARDED;
+    }
+
+    /*@ put the forwarded record into the destination page */
+    if (SP_CFREE(dstPage) < sizeof(ObjectHdr) + ALIGNED_LENGTH(length) + sizeof(SlottedPageSlot)) {
+        e = EduOM_CompactPage(dstPage, NIL);
+        if (e < 0) ERR(e);
+    }
+
+    e = eduom_InsertInPage(dstPage, &objHdr, length, data, newOid);
+    if (e < 0) ERR(e);
+
+    if (obj->header.properties & P_FORWARDED) {
+        /*@ let the stub point to the new place and drop the old record */
+        e = eduom_RetargetStub(&stubOid, newOid);
+        if (e < 0) ERR(e);
+
+        e = eduom_RemoveFromPage(srcPage, slotNo);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    /*@ turn the object into a stub */
+    e = eduom_ResizeInPage(srcPage, slotNo, FWD_BACKPTR_LEN);
+    if (e < 0) ERR(e);
+
+    obj = (Object *)&(srcPage->data[srcPage->slot[-slotNo].offset]);
+    obj->header.properties |= P_MOVED;
+    memcpy(obj->data, newOid, sizeof(ObjectID));
+
+    return(eNOERROR);
+
+} /* eduom_RelocateObject() */
+
+
+
+/*@================================
+ * eduom_RetargetStub()
+ *================================*/
+/*
+ * Function: Four eduom_RetargetStub(ObjectID*, ObjectID*)
+ *
+ * Description :
+ *  Let the forwarding stub 'stubOid' point to the record 'newOid'.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_RetargetStub(
+    ObjectID	*stubOid,	/* IN the stub */
+    ObjectID	*newOid)	/* IN new place of the record */
+{
+    Four        e;		/* error number */
+    PageID      stubPid;	/* page holding the stub */
+    SlottedPage *stubPage;	/* buffer holding the stub */
+    Object      *stub;		/* the stub */
+
+
+    MAKE_PAGEID(stubPid, stubOid->volNo, stubOid->pageNo);
+    e = BfM_GetTrain(&stubPid, (char **)&stubPage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    stub = (Object *)&(stubPage->data[stubPage->slot[-(stubOid->slotNo)].offset]);
+    memcpy(stub->data, newOid, sizeof(ObjectID));
+
+    e = eduom_SetDirty(&stubPid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &stubPid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&stubPid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* eduom_RetargetStub() */
+
+
+
+/*@================================
+ * eduom_ResizeInPage()
+ *================================*/
+/*
+ * Function: Four eduom_ResizeInPage(SlottedPage*, Two, Four)
+ *
+ * Description :
+ *  Change the length of the record in the slot 'slotNo' to 'length' bytes
+ *  keeping it in the page. A record growing beyond the contiguous free
+ *  area is moved to the end of the data area by compacting the page. The
+ *  caller must guarantee that the page has enough free space and must fill
+ *  in the new data; the data up to the old length are kept.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_ResizeInPage(
+    SlottedPage	*apage,		/* INOUT page holding the record */
+    Two		slotNo,		/* IN slot of the record */
+    Four	length)		/* IN new length of the record */
+{
+    Four        e;		/* error number */
+    Four        offset;		/* offset of the record */
+    Object      *obj;		/* the record */
+    Four        oldLen;		/* aligned length of the record */
+    Four        newLen;		/* new aligned length of the record */
+
+
+    offset = apage->slot[-slotNo].offset;
+    obj = (Object *)&(apage->data[offset]);
+    oldLen = ALIGNED_LENGTH(obj->header.length);
+    newLen = ALIGNED_LENGTH(length);
+
+    if (newLen > oldLen) {
+        /* grow the record at the end of the data area */
+        if (offset + sizeof(ObjectHdr) + oldLen != apage->header.free ||
+            SP_CFREE(apage) < newLen - oldLen) {
+            e = EduOM_CompactPage(apage, slotNo);
+            if (e < 0) ERR(e);
+
+            offset = apage->slot[-slotNo].offset;
+        }
+        apage->header.free = offset + sizeof(ObjectHdr) + newLen;
+
+    } else if (offset + sizeof(ObjectHdr) + oldLen == apage->header.free)
+        apage->header.free = offset + sizeof(ObjectHdr) + newLen;
+    else
+        apage->header.unused += oldLen - newLen;
+
+    ((Object *)&(apage->data[offset]))->header.length = length;
+
+    return(eNOERROR);
+
+} /* eduom_ResizeInPage() */
+
+
+
+/*@================================
+ * eduom_RemoveFromPage()
+ *================================*/
+/*
+ * Function: Four eduom_RemoveFromPage(SlottedPage*, Two)
+ *
+ * Description :
+ *  Remove the record in the slot 'slotNo' from the page in the same way as
+ *  EduOM_DestroyObject() does. The page is not moved in the available
+ *  space lists.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_RemoveFromPage(
+    SlottedPage	*apage,		/* INOUT page holding the record */
+    Two		slotNo)		/* IN slot of the record */
+{
+    Four        e;		/* error number */
+    Four        offset;		/* offset of the record */
+    Four        alignedLen;	/* aligned length of the record */
+
+
+    offset = apage->slot[-slotNo].offset;
+    alignedLen = ALIGNED_LENGTH(((Object *)&(apage->data[offset]))->header.length);
+
+    apage->slot[-slotNo].offset = EMPTYSLOT;
+
+    if (slotNo == apage->header.nSlots - 1)
+        apage->header.nSlots--;
+    else {
+        e = eduom_PutFreeSlot(apage, slotNo);
+        if (e < 0) ERR(e);
+    }
+
+    if (offset + sizeof(ObjectHdr) + alignedLen == apage->header.free)
+        apage->header.free = offset;
+    else
+        apage->header.unused += sizeof(ObjectHdr) + alignedLen;
+
+    return(eNOERROR);
+
+} /* eduom_RemoveFromPage() */
@@ -0,0 +1,453 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduOM_ForwardTest.c
+ *
+ * Description :
+ *  Regression test of the forwarding of objects. Objects are moved by
+ *  EduOM_ReorganizeFile() and EduOM_UpdateObject(), read and iterated
+ *  through their stubs, moved back by EduOM_CollapseForwarding() and
+ *  destroyed. Large objects are then created, appended to and destroyed
+ *  in the empty file.
+ *  It replaces EduOM_Test.c in the EduOM_ForwardTest executable and prints
+ *  "EduOM_ForwardTest passed" when every check holds.
+ *
+ * Exports:
+ *  Four EduOM_Test(Four, Four, Boolean)
+ */
+#include <string.h>
+#include "EduOM_common.h"
+#include "EduOM.h"
+#include "EduOM_Internal.h"
+#include "EduOM_TestModule.h"
+
+
+#define FWDTEST_NOBJECTS	180	/* # of objects in the reorganized file */
+#define FWDTEST_OBJSIZE		200	/* size of the objects created */
+#define FWDTEST_BIGSIZE		2000	/* size an object is updated to */
+#define FWDTEST_LRGAPPEND	3000	/* # of bytes appended to a large object */
+#define FWDTEST_LRGMAX		(45*1024 + FWDTEST_LRGAPPEND) /* largest large object */
+
+/* Macro: FWDTEST_CHECK(cond, msg)
+ * Description: print 'msg' and fail the test if 'cond' does not hold
+ */
+#define FWDTEST_CHECK(cond, msg) \
+BEGIN_MACRO \
+    if (!(cond)) { \
+        printf("FAIL : %s (%s:%d)\n", (msg), __FILE__, __LINE__); \
+        return(eBADPARAMETER_OM); \
+    } \
+END_MACRO
+
+
+static ObjectID fwdOid[FWDTEST_NOBJECTS];	/* objects of the file */
+static Boolean  fwdLive[FWDTEST_NOBJECTS];	/* TRUE if the object exists */
+static Four     fwdLength[FWDTEST_NOBJECTS];	/* length of the object */
+static ObjectID fwdWalk[FWDTEST_NOBJECTS];	/* objects in the order of NextObject */
+static char     fwdLrgExpected[FWDTEST_LRGMAX];	/* contents of a large object */
+static char     fwdLrgBuf[FWDTEST_LRGMAX];	/* contents read of a large object */
+
+
+
+/*@================================
+ * fwdtest_Fill()
+ *================================*/
+/*
+ * Function: void fwdtest_Fill(char*, Four, Four)
+ *
+ * Description :
+ *  Fill 'buf' with the contents of the object 'n'.
+ */
+static void fwdtest_Fill(
+    char		*buf,		/* OUT contents of the object */
+    Four		n,		/* IN number of the object */
+    Four		length)		/* IN length of the object */
+{
+    Four		i;		/* index */
+
+
+    for (i = 0; i < length; i++)
+        buf[i] = 'a' + (n + i) % 26;
+
+} /* fwdtest_Fill() */
+
+
+
+/*@================================
+ * fwdtest_CheckFile()
+ *================================*/
+/*
+ * Function: Four fwdtest_CheckFile(ObjectID*, Four)
+ *
+ * Description :
+ *  Read every live object through its original ObjectID and walk the file
+ *  with EduOM_NextObject(); every live object must be found once with its
+ *  contents unchanged.
+ *
+ * Returns:
+ *  error code
+ */
+static Four fwdtest_CheckFile(
+    ObjectID		*catObjForFile,	/* IN file to check */
+    Four		nObjects)	/* IN # of objects created */
+{
+    Four		e;		/* error number */
+    Four		i;		/* index */
+    Four		nLive;		/* # of live objects */
+    Four		nFound;		/* # of objects walked */
+    ObjectID		oid;		/* object walked */
+    ObjectHdr		objHdr;		/* header of the object walked */
+    char		expected[FWDTEST_BIGSIZE];	/* contents expected */
+    char		buf[FWDTEST_BIGSIZE];		/* contents read */
+
+
+    for (nLive = 0, i = 0; i < nObjects; i++) {
+        if (!fwdLive[i]) continue;
+        nLive++;
+
+        fwdtest_Fill(expected, i, fwdLength[i]);
+        e = EduOM_ReadObject(&fwdOid[i], 0, REMAINDER, buf);
+        if (e < eNOERROR) ERR(e);
+
+        FWDTEST_CHECK(e == fwdLength[i] && memcmp(buf, expected, fwdLength[i]) == 0,
+                      "object read through its ObjectID");
+    }
+
+    nFound = 0;
+    e = EduOM_NextObject(catObjForFile, NULL, &oid, &objHdr);
+    while (e == eNOERROR) {
+        for (i = 0; i < nObjects; i++)
+            if (fwdLive[i] && EQUAL_PAGEID(fwdOid[i], oid) && fwdOid[i].slotNo == oid.slotNo) break;
+
+        FWDTEST_CHECK(i < nObjects, "NextObject returns a live ObjectID");
+        FWDTEST_CHECK(objHdr.length == fwdLength[i], "NextObject returns the user length");
+        nFound++;
+
+        e = EduOM_NextObject(catObjForFile, &oid, &oid, &objHdr);
+    }
+    if (e < eNOERROR) ERR(e);
+
+    FWDTEST_CHECK(nFound == nLive, "NextObject visits every live object once");
+
+    return(eNOERROR);
+
+} /* fwdtest_CheckFile() */
+
+
+
+/*@================================
+ * fwdtest_IterateFile()
+ *================================*/
+/*
+ * Function: Four fwdtest_IterateFile(ObjectID*, Four)
+ *
+ * Description :
+ *  Iterate the file forward with EduOM_NextObject(), backward with
+ *  EduOM_PrevObject() and with a scan; the three must return the same live
+ *  objects, by their original ObjectIDs, in the same order.
+ *
+ * Returns:
+ *  error code
+ */
+static Four fwdtest_IterateFile(
+    ObjectID		*catObjForFile,	/* IN file to iterate */
+    Four		nObjects)	/* IN # of objects created */
+{
+    Four		e;		/* error number */
+    Four		i;		/* index */
+    Four		nLive;		/* # of live objects */
+    Four		nWalked;	/* # of objects returned by NextObject */
+    Four		n;		/* # of objects returned by the others */
+    ObjectID		oid;		/* object returned */
+    ObjectHdr		objHdr;		/* header of the object returned */
+    ScanCursor		cursor;		/* scan of the file */
+
+
+    for (nLive = 0, i = 0; i < nObjects; i++)
+        if (fwdLive[i]) nLive++;
+
+    nWalked = 0;
+    e = EduOM_NextObject(catObjForFile, NULL, &oid, &objHdr);
+    while (e == eNOERROR) {
+        FWDTEST_CHECK(nWalked < nLive, "NextObject returns no more than the live objects");
+        fwdWalk[nWalked++] = oid;
+
+        e = EduOM_NextObject(catObjForFile, &oid, &oid, &objHdr);
+    }
+    if (e < eNOERROR) ERR(e);
+
+    FWDTEST_CHECK(nWalked == nLive, "NextObject returns every live object");
+
+    n = 0;
+    e = EduOM_PrevObject(catObjForFile, NULL, &oid, &objHdr);
+    while (e == eNOERROR) {
+        FWDTEST_CHECK(n < nWalked, "PrevObject returns no more than NextObject");
+        FWDTEST_CHECK(EQUAL_PAGEID(oid, fwdWalk[nWalked - 1 - n]) &&
+                      oid.slotNo == fwdWalk[nWalked - 1 - n].slotNo,
+                      "PrevObject returns the objects of NextObject in reverse");
+        n++;
+
+        e = EduOM_PrevObject(catObjForFile, &oid, &oid, &objHdr);
+    }
+    if (e < eNOERROR) ERR(e);
+
+    FWDTEST_CHECK(n == nWalked, "PrevObject returns every live object");
+
+    e = EduOM_OpenScan(catObjForFile, &cursor);
+    if (e < eNOERROR) ERR(e);
+
+    n = 0;
+    while ((e = EduOM_ScanNext(&cursor, &oid, &objHdr)) == eNOERROR) {
+        if (n >= nWalked || !EQUAL_PAGEID(oid, fwdWalk[n]) || oid.slotNo != fwdWalk[n].slotNo) break;
+        n++;
+    }
+    if (e < eNOERROR) {
+        (Four) EduOM_CloseScan(&cursor);
+        ERR(e);
+    }
+
+    e = EduOM_CloseScan(&cursor);
+    if (e < eNOERROR) ERR(e);
+
+    FWDTEST_CHECK(n == nWalked, "ScanNext returns the objects of NextObject in order");
+
+    return(eNOERROR);
+
+} /* fwdtest_IterateFile() */
+
+
+
+/*@================================
+ * fwdtest_LargeObject()
+ *================================*/
+/*
+ * Function: Four fwdtest_LargeObject(ObjectID*, Four)
+ *
+ * Description :
+ *  Create a large object of 'length' bytes, read it, append to it, read it
+ *  again and destroy it.
+ *
+ * Returns:
+ *  error code
+ */
+static Four fwdtest_LargeObject(
+    ObjectID		*catObjForFile,	/* IN file of the object */
+    Four		length)		/* IN initial length of the object */
+{
+    Four		e;		/* error number */
+    ObjectID		oid;		/* the large object */
+    ObjectHdr		objHdr;		/* header of the object */
+
+
+    fwdtest_Fill(fwdLrgExpected, length, length + FWDTEST_LRGAPPEND);
+
+    e = EduOM_CreateObject(catObjForFile, NULL, NULL, length, fwdLrgExpected, &oid);
+    if (e < eNOERROR) ERR(e);
+
+    e = EduOM_ReadObject(&oid, 0, REMAINDER, fwdLrgBuf);
+    if (e < eNOERROR) ERR(e);
+    FWDTEST_CHECK(e == length && memcmp(fwdLrgBuf, fwdLrgExpected, length) == 0,
+                  "large object read after its creation");
+
+    e = EduOM_AppendToObject(catObjForFile, &oid, FWDTEST_LRGAPPEND, &fwdLrgExpected[length],
+                             &dlPool, &dlHead);
+    if (e < eNOERROR) ERR(e);
+
+    e = EduOM_ReadObject(&oid, 0, REMAINDER, fwdLrgBuf);
+    if (e < eNOERROR) ERR(e);
+    FWDTEST_CHECK(e == length + FWDTEST_LRGAPPEND &&
+                  memcmp(fwdLrgBuf, fwdLrgExpected, length + FWDTEST_LRGAPPEND) == 0,
+                  "large object read after an append");
+
+    e = EduOM_NextObject(catObjForFile, NULL, &oid, &objHdr);
+    if (e < eNOERROR) ERR(e);
+    FWDTEST_CHECK(e == eNOERROR && objHdr.length == length + FWDTEST_LRGAPPEND,
+                  "NextObject returns the length of the large object");
+
+    e = EduOM_DestroyObject(catObjForFile, &oid, &dlPool, &dlHead);
+    if (e < eNOERROR) ERR(e);
+
+    e = EduOM_NextObject(catObjForFile, NULL, &oid, NULL);
+    if (e < eNOERROR) ERR(e);
+    FWDTEST_CHECK(e == EOS, "no object is left after the large object is destroyed");
+
+    return(eNOERROR);
+
+} /* fwdtest_LargeObject() */
+
+
+
+/*@================================
+ * EduOM_Test()
+ *================================*/
+/*
+ * Function: Four EduOM_Test(Four, Four, Boolean)
+ *
+ * Description :
+ *  (1) Create a file, destroy two thirds of its objects and reorganize it
+ *      so that the objects left are moved and leave stubs; then iterate it.
+ *  (2) Update objects to grow them, which moves full-page objects again.
+ *  (3) Make room in the pages of the stubs and collapse the forwarding.
+ *  (4) Destroy every object; the pages holding only stubs must be freed.
+ *  (5) Create, read, append to and destroy large objects in the empty file.
+ *  The file is checked after every step.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four EduOM_Test(Four volId, Four handle, Boolean getcharFlag)
+{
+    Four		e;		/* error number */
+    Four		i;		/* index */
+    Four		nCollapsed;	/* # of objects moved back by a call */
+    Four		nTotal;		/* # of objects moved back */
+    Four		nFreed;		/* # of pages deallocated */
+    PageNo		pageNo;		/* page to continue collapsing from */
+    FileID		fid;		/* file identifier */
+    ObjectID		catalogEntry;	/* catalog object of the file */
+    ObjectID		oid;		/* object walked */
+    EduOM_ReorgResult	result;		/* result of the reorganization */
+    DeallocListElem	*dlElem;	/* element of dealloc list */
+    DeallocListElem	*dlLast;	/* first element before the destroy */
+    char		buf[FWDTEST_BIGSIZE];	/* contents of an object */
+
+
+    e = SM_CreateFile(volId, &fid, FALSE, NULL);
+    if (e < eNOERROR) ERR(e);
+
+    e = sm_GetCatalogEntryFromDataFileId(ARRAYINDEX, &fid, &catalogEntry);
+    if (e < eNOERROR) ERR(e);
+
+    /*@ (1) move the objects of sparse pages */
+    for (i = 0; i < FWDTEST_NOBJECTS; i++) {
+        fwdLength[i] = FWDTEST_OBJSIZE;
+        fwdtest_Fill(buf, i, fwdLength[i]);
+        e = EduOM_CreateObject(&catalogEntry, (i == 0) ? NULL : &fwdOid[i-1], NULL,
+                               fwdLength[i], buf, &fwdOid[i]);
+        if (e < eNOERROR) ERR(e);
+        fwdLive[i] = TRUE;
+    }
+
+    for (i = 0; i < FWDTEST_NOBJECTS; i++) {
+        if (i % 3 == 0) continue;
+
+        e = EduOM_DestroyObject(&catalogEntry, &fwdOid[i], &dlPool, &dlHead);
+        if (e < eNOERROR) ERR(e);
+        fwdLive[i] = FALSE;
+    }
+
+    e = EduOM_ReorganizeFile(&catalogEntry, 90, &dlPool, &dlHead, &result);
+    if (e < eNOERROR) ERR(e);
+
+    FWDTEST_CHECK(result.nObjectsMoved > 0, "ReorganizeFile moves objects");
+    FWDTEST_CHECK(result.nPagesUnlinked > 0, "ReorganizeFile unlinks stub-only pages");
+    FWDTEST_CHECK(result.nPagesAfter < result.nPagesBefore, "ReorganizeFile shortens the page list");
+
+    e = fwdtest_CheckFile(&catalogEntry, FWDTEST_NOBJECTS);
+    if (e < eNOERROR) return(e);
+    printf("PASS : move and read through stubs\n");
+
+    e = fwdtest_IterateFile(&catalogEntry, FWDTEST_NOBJECTS);
+    if (e < eNOERROR) return(e);
+    printf("PASS : iterate the reorganized file forward, backward and by a scan\n");
+
+    /*@ (2) grow objects; those in full pages are moved again */
+    for (i = 0; i < FWDTEST_NOBJECTS; i += 9) {
+        fwdLength[i] = FWDTEST_BIGSIZE;
+        fwdtest_Fill(buf, i, fwdLength[i]);
+        e = EduOM_UpdateObject(&catalogEntry, &fwdOid[i], fwdLength[i], buf);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    e = fwdtest_CheckFile(&catalogEntry, FWDTEST_NOBJECTS);
+    if (e < eNOERROR) return(e);
+    printf("PASS : update of moved objects\n");
+
+    /*@ (3) shrink the objects back and collapse the forwarding */
+    for (i = 0; i < FWDTEST_NOBJECTS; i += 9) {
+        fwdLength[i] = FWDTEST_OBJSIZE / 2;
+        fwdtest_Fill(buf, i, fwdLength[i]);
+        e = EduOM_UpdateObject(&catalogEntry, &fwdOid[i], fwdLength[i], buf);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    for (i = 3; i < FWDTEST_NOBJECTS; i += 9) {
+        e = EduOM_DestroyObject(&catalogEntry, &fwdOid[i], &dlPool, &dlHead);
+        if (e < eNOERROR) ERR(e);
+        fwdLive[i] = FALSE;
+    }
+
+    nTotal = 0;
+    pageNo = NIL;
+    do {
+        e = EduOM_CollapseForwarding(&catalogEntry, &pageNo, 2, &nCollapsed);
+        if (e < eNOERROR) ERR(e);
+        nTotal += nCollapsed;
+    } while (pageNo != NIL);
+
+    FWDTEST_CHECK(nTotal > 0, "CollapseForwarding moves objects back");
+
+    e = fwdtest_CheckFile(&catalogEntry, FWDTEST_NOBJECTS);
+    if (e < eNOERROR) return(e);
+    printf("PASS : collapse of %ld forwarded objects\n", (long)nTotal);
+
+    /*@ (4) destroy every object through its stub */
+    dlLast = dlHead.next;
+    for (i = 0; i < FWDTEST_NOBJECTS; i++) {
+        if (!fwdLive[i]) continue;
+
+        e = EduOM_DestroyObject(&catalogEntry, &fwdOid[i], &dlPool, &dlHead);
+        if (e < eNOERROR) ERR(e);
+        fwdLive[i] = FALSE;
+    }
+
+    /* the pages freed are pushed in front of the dealloc list */
+    nFreed = 0;
+    for (dlElem = dlHead.next; dlElem != dlLast; dlElem = dlElem->next)
+        if (dlElem->type == DL_PAGE) nFreed++;
+
+    e = EduOM_NextObject(&catalogEntry, NULL, &oid, NULL);
+    if (e < eNOERROR) ERR(e);
+    FWDTEST_CHECK(e == EOS, "no object is left in the file");
+    FWDTEST_CHECK(nFreed >= result.nPagesUnlinked, "stub-only pages are freed with their last stub");
+    printf("PASS : destroy through stubs (%ld pages freed)\n", (long)nFreed);
+
+    /*@ (5) large objects of one and of several trains */
+    e = fwdtest_LargeObject(&catalogEntry, 5*1024);
+    if (e < eNOERROR) return(e);
+
+    e = fwdtest_LargeObject(&catalogEntry, 15*1024);
+    if (e < eNOERROR) return(e);
+
+    e = fwdtest_LargeObject(&catalogEntry, 45*1024);
+    if (e < eNOERROR) return(e);
+    printf("PASS : large objects of 5, 15 and 45 KB\n");
+
+    printf("EduOM_ForwardTest passed\n");
+
+    return(eNOERROR);
+
+} /* EduOM_Test() */
@@ -0,0 +1,194 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_FreeSlotList.c
+ * 
+ * Description :
+ *  Maintain the list of the empty slots of a slotted page so that an empty
+ *  slot is found without scanning the slot array.
+ *
+ * Internal Exports:
+ *  Four eduom_GetFreeSlot(SlottedPage*, Two*)
+ *  Four eduom_PutFreeSlot(SlottedPage*, Two)
+ *  Four eduom_RebuildFreeSlotList(SlottedPage*)
+ */
+
+#include "EduOM_common.h"
+#include "EduOM_Internal.h"
+
+/* Macro: IS_LISTED_FREESLOT(p, s)
+ * Description: check whether the slot 's' can be on the free slot list
+ */
+#define IS_LISTED_FREESLOT(p, s) \
+	(((s) >= 0 && (s) < (p)->header.nSlots && (p)->slot[-(s)].offset == EMPTYSLOT) ? TRUE : FALSE)
+
+
+
+/*@================================
+ * eduom_GetFreeSlot()
+ *================================*/
+/*
+ * Function: Four eduom_GetFreeSlot(SlottedPage*, Two*)
+ *
+ * Description :
+ *  Take the first empty slot off the free slot list of the page.
+ *  If the page is of the old format or the list is found to be stale, the
+ *  list is rebuilt from the slot array first.
+ *
+ * Returns:
+ *  error code
+ *    eNOERROR
+ *
+ * Side Effects :
+ *  1) parameter slotNo
+ *     'slotNo' is set to the empty slot taken off the list, or NIL if the
+ *     page has no empty slot.
+ */
+Four eduom_GetFreeSlot(
+    SlottedPage *apage,		/* INOUT slotted page */
+    Two         *slotNo)	/* OUT empty slot or NIL */
+{
+    Two         head;		/* first empty slot */
+
+
+    if (!SP_HAS_FREESLOTLIST(apage)) eduom_RebuildFreeSlotList(apage);
+
+    head = SP_FREESLOT_HEAD(apage);
+
+    if (head != NIL && !IS_LISTED_FREESLOT(apage, head)) {
+        /* the page has been modified without maintaining the list */
+        eduom_RebuildFreeSlotList(apage);
+        head = SP_FREESLOT_HEAD(apage);
+    }
+
+    if (head != NIL) SET_SP_FREESLOT_HEAD(apage, (Two)SP_NEXT_FREESLOT(apage, head));
+
+    *slotNo = head;
+
+    return(eNOERROR);
+
+} /* eduom_GetFreeSlot() */
+
+
+
+/*@================================
+ * eduom_PutFreeSlot()
+ *================================*/
+/*
+ * Function: Four eduom_PutFreeSlot(SlottedPage*, Two)
+ *
+ * Description :
+ *  Put the slot, which must already be set to EMPTYSLOT, into the free slot
+ *  list of the page. The list is kept in the ascending order of the slot
+ *  number so that the lowest empty slot is reused first, as the slot array
+ *  scan this list replaced did; the ObjectIDs given to new objects, and so
+ *  the expected output of the EduOM test, depend on that order. Keeping
+ *  the order costs a walk over the empty slots below 'slotNo' instead of a
+ *  push at the head; the walk touches only the slot array of the page,
+ *  which is fixed in the buffer already, and taking a slot off the list
+ *  stays O(1).
+ *
+ * Returns:
+ *  error code
+ *    eNOERROR
+ */
+Four eduom_PutFreeSlot(
+    SlottedPage *apage,		/* INOUT slotted page */
+    Two         slotNo)		/* IN slot which became empty */
+{
+    Two         prev;		/* empty slot before the 'slotNo' */
+    Two         cur;		/* empty slot after the 'slotNo' */
+
+
+    if (!SP_HAS_FREESLOTLIST(apage)) {
+        /* rebuilding picks up the 'slotNo' also */
+        eduom_RebuildFreeSlotList(apage);
+        return(eNOERROR);
+    }
+
+    prev = NIL;
+    cur = SP_FREESLOT_HEAD(apage);
+    while (cur != NIL && cur < slotNo) {
+        if (!IS_LISTED_FREESLOT(apage, cur)) {
+            eduom_RebuildFreeSlotList(apage);
+            return(eNOERROR);
+        }
+        prev = cur;
+        cur = (Two)SP_NEXT_FREESLOT(apage, cur);
+        if (cur != NIL && cur <= prev) {
+            eduom_RebuildFreeSlotList(apage);
+            return(eNOERROR);
+        }
+    }
+
+    if (cur == slotNo) return(eNOERROR); /* already on the list */
+
+    SP_NEXT_FREESLOT(apage, slotNo) = (Unique)cur;
+    if (prev == NIL)
+        SET_SP_FREESLOT_HEAD(apage, slotNo);
+    else
+        SP_NEXT_FREESLOT(apage, prev) = (Unique)slotNo;
+
+    return(eNOERROR);
+
+} /* eduom_PutFreeSlot() */
+
+
+
+/*@================================
+ * eduom_RebuildFreeSlotList()
+ *================================*/
+/*
+ * Function: Four eduom_RebuildFreeSlotList(SlottedPage*)
+ *
+ * Description :
+ *  Build the free slot list of the page from the slot array. This converts
+ *  a page of the old format, whose 'reserved' field does not hold the list,
+ *  and repairs a list made stale by the modules not maintaining it.
+ *
+ * Returns:
+ *  error code
+ *    eNOERROR
+ */
+Four eduom_RebuildFreeSlotList(
+    SlottedPage *apage)		/* INOUT slotted page */
+{
+    Two         i;		/* index variable */
+    Two         head;		/* first empty slot found so far */
+
+
+    head = NIL;
+    for (i = apage->header.nSlots - 1; i >= 0; i--) {
+        if (apage->slot[-i].offset == EMPTYSLOT) {
+            SP_NEXT_FREESLOT(apage, i) = (Unique)head;
+            head = i;
+        }
+    }
+
+    SET_SP_FREESLOT_HEAD(apage, head);
+
+    return(eNOERROR);
+
+} /* eduom_RebuildFreeSlotList() */
@@ -0,0 +1,547 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_FreeSpaceMap.c
+ * 
+ * Description :
+ *  Keep in memory a free space map of the data files used by EduOM. The map
+ *  holds a 4-bit free space class for each page of the file; the class of a
+ *  page is its free space in units of 1/16 of the page. The pages of the
+ *  same class are linked so that a page with enough free space is found in
+ *  constant time, picking the fullest such page (best fit).
+ *
+ *  The map of a file is built from the available space lists when the file
+ *  is first used and is kept up to date by the available space list
+ *  routines. The available space lists remain the persistent record of the
+ *  free space; the map is only a hint and a page taken from it must be
+ *  checked by the caller.
+ *
+ * Internal Exports:
+ *  Four eduom_FindPageInFreeSpaceMap(ObjectID*, Four, PageNo*)
+ *  Four eduom_FindPageInFreeSpaceMapRange(ObjectID*, Four, PageNo, Four, PageNo*)
+ *  Four eduom_SetFreeSpaceMap(ObjectID*, PageID*, Four)
+ *  Four eduom_ClearFreeSpaceMap(ObjectID*, PageID*)
+ *  void eduom_DropFreeSpaceMap(ObjectID*)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduOM_common.h"
+#include "BfM.h"		/* for the buffer manager call */
+#include "EduOM_Internal.h"
+
+
+/* number of data files whose free space map is kept in memory */
+#define EDUOM_FSM_SIZE		16
+
+/* number of free space classes and the free space covered by a class */
+#define EDUOM_FSM_NCLASSES	16
+#define EDUOM_FSM_CLASSSIZE	(PAGESIZE / EDUOM_FSM_NCLASSES)
+
+/* link value of a page not in the map */
+#define EDUOM_FSM_NOTIN		(-2)
+
+/*
+ * Typedef for the free space map of a data file
+ */
+typedef struct {
+	Boolean		valid;		/* TRUE if the entry holds a map */
+	ObjectID	catObjForFile;	/* catalog object of the data file */
+	Four		nPages;		/* pages numbered less than this are covered */
+	unsigned char	*fsClass;	/* free space classes, two pages per byte */
+	ShortPageID	*next;		/* next page of the same class */
+	ShortPageID	*prev;		/* previous page of the same class */
+	ShortPageID	head[EDUOM_FSM_NCLASSES]; /* first page of each class */
+} eduom_FreeSpaceMap;
+
+static eduom_FreeSpaceMap eduom_fsMap[EDUOM_FSM_SIZE];
+static Four eduom_fsMapVictim = 0;	/* next entry to be replaced */
+
+
+/* Macro: FSM_GET_CLASS(m, p), FSM_SET_CLASS(m, p, c)
+ * Description: access the 4-bit free space class of the page 'p'
+ */
+#define FSM_GET_CLASS(m, p) \
+	(((p) & 1) ? ((m)->fsClass[(p) >> 1] >> 4) : ((m)->fsClass[(p) >> 1] & 0x0F))
+#define FSM_SET_CLASS(m, p, c) \
+	((m)->fsClass[(p) >> 1] = ((p) & 1) ? \
+	 (((m)->fsClass[(p) >> 1] & 0x0F) | ((c) << 4)) : \
+	 (((m)->fsClass[(p) >> 1] & 0xF0) | (c)))
+
+/* Macro: EQUAL_OBJECTID(x, y)
+ * Description: check whether the two object IDs are equal
+ */
+#define EQUAL_OBJECTID(x, y) \
+	(((x).volNo == (y).volNo && (x).pageNo == (y).pageNo && \
+	  (x).slotNo == (y).slotNo && (x).unique == (y).unique) ? TRUE : FALSE)
+
+
+
+/*@================================
+ * eduom_FreeMapEntry()
+ *================================*/
+/*
+ * Function: void eduom_FreeMapEntry(eduom_FreeSpaceMap*)
+ *
+ * Description :
+ *  Release the memory of the map and mark the entry unused.
+ */
+static void eduom_FreeMapEntry(
+    eduom_FreeSpaceMap	*map)		/* INOUT map to release */
+{
+    free(map->fsClass);
+    free(map->next);
+    free(map->prev);
+
+    map->fsClass = NULL;
+    map->next = NULL;
+    map->prev = NULL;
+    map->nPages = 0;
+    map->valid = FALSE;
+
+} /* eduom_FreeMapEntry() */
+
+
+
+/*@================================
+ * eduom_ExtendMap()
+ *================================*/
+/*
+ * Function: Boolean eduom_ExtendMap(eduom_FreeSpaceMap*, PageNo)
+ *
+ * Description :
+ *  Make the map cover the page 'pageNo'.
+ *
+ * Returns:
+ *  FALSE if the memory is exhausted
+ */
+static Boolean eduom_ExtendMap(
+    eduom_FreeSpaceMap	*map,		/* INOUT map to extend */
+    PageNo		pageNo)		/* IN page to be covered */
+{
+    Four		nPages;		/* new # of pages covered */
+    Four		i;		/* index variable */
+    unsigned char	*fsClass;	/* reallocated class array */
+    ShortPageID		*next;		/* reallocated link array */
+    ShortPageID		*prev;		/* reallocated link array */
+
+
+    if (pageNo < map->nPages) return(TRUE);
+
+    for (nPages = (map->nPages > 0) ? map->nPages : 1024; nPages <= pageNo; nPages *= 2);
+
+    fsClass = (unsigned char *)realloc(map->fsClass, (nPages + 1) / 2);
+    if (fsClass == NULL) return(FALSE);
+    map->fsClass = fsClass;
+
+    next = (ShortPageID *)realloc(map->next, nPages * sizeof(ShortPageID));
+    if (next == NULL) return(FALSE);
+    map->next = next;
+
+    prev = (ShortPageID *)realloc(map->prev, nPages * sizeof(ShortPageID));
+    if (prev == NULL) return(FALSE);
+    map->prev = prev;
+
+    memset(&(map->fsClass[(map->nPages + 1) / 2]), 0, (nPages + 1) / 2 - (map->nPages + 1) / 2);
+    for (i = map->nPages; i < nPages; i++)
+        map->next[i] = map->prev[i] = EDUOM_FSM_NOTIN;
+
+    map->nPages = nPages;
+
+    return(TRUE);
+
+} /* eduom_ExtendMap() */
+
+
+
+/*@================================
+ * eduom_MapRemovePage()
+ *================================*/
+/*
+ * Function: void eduom_MapRemovePage(eduom_FreeSpaceMap*, PageNo)
+ *
+ * Description :
+ *  Unlink the page from the list of its class if it is in the map.
+ */
+static void eduom_MapRemovePage(
+    eduom_FreeSpaceMap	*map,		/* INOUT map */
+    PageNo		pageNo)		/* IN page to remove */
+{
+    Four		c;		/* free space class of the page */
+
+
+    if (pageNo >= map->nPages || map->next[pageNo] == EDUOM_FSM_NOTIN) return;
+
+    c = FSM_GET_CLASS(map, pageNo);
+
+    if (map->prev[pageNo] == NIL)
+        map->head[c] = map->next[pageNo];
+    else
+        map->next[map->prev[pageNo]] = map->next[pageNo];
+
+    if (map->next[pageNo] != NIL)
+        map->prev[map->next[pageNo]] = map->prev[pageNo];
+
+    map->next[pageNo] = map->prev[pageNo] = EDUOM_FSM_NOTIN;
+
+} /* eduom_MapRemovePage() */
+
+
+
+/*@================================
+ * eduom_MapSetPage()
+ *================================*/
+/*
+ * Function: void eduom_MapSetPage(eduom_FreeSpaceMap*, PageNo, Four)
+ *
+ * Description :
+ *  Record that the page has 'freeSpace' bytes of free space. If the map
+ *  cannot be extended, the map is dropped.
+ */
+static void eduom_MapSetPage(
+    eduom_FreeSpaceMap	*map,		/* INOUT map */
+    PageNo		pageNo,		/* IN page whose free space changed */
+    Four		freeSpace)	/* IN free space of the page */
+{
+    Four		c;		/* free space class of the page */
+
+
+    if (!eduom_ExtendMap(map, pageNo)) {
+        eduom_FreeMapEntry(map);
+        return;
+    }
+
+    c = freeSpace / EDUOM_FSM_CLASSSIZE;
+    if (c >= EDUOM_FSM_NCLASSES) c = EDUOM_FSM_NCLASSES - 1;
+
+    if (map->next[pageNo] != EDUOM_FSM_NOTIN) {
+        if (FSM_GET_CLASS(map, pageNo) == c) return;
+        eduom_MapRemovePage(map, pageNo);
+    }
+
+    FSM_SET_CLASS(map, pageNo, c);
+
+    map->prev[pageNo] = NIL;
+    map->next[pageNo] = map->head[c];
+    if (map->head[c] != NIL) map->prev[map->head[c]] = pageNo;
+    map->head[c] = pageNo;
+
+} /* eduom_MapSetPage() */
+
+
+
+/*@================================
+ * eduom_GetFreeSpaceMap()
+ *================================*/
+/*
+ * Function: Four eduom_GetFreeSpaceMap(ObjectID*, eduom_FreeSpaceMap**)
+ *
+ * Description :
+ *  Return the free space map of the data file. On a miss the map is built
+ *  from the pages in the available space lists and the last page.
+ *  If the memory is exhausted, NULL is returned as the map.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_GetFreeSpaceMap(
+    ObjectID		*catObjForFile,	/* IN catalog object of the data file */
+    eduom_FreeSpaceMap	**map)		/* OUT free space map of the file */
+{
+    Four		e;		/* error number */
+    Four		i;		/* index variable */
+    eduom_FreeSpaceMap	*entry;		/* map entry */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+    ShortPageID		lists[5];	/* heads of the available space lists */
+    PageID		pid;		/* page in the list */
+    SlottedPage		*apage;		/* buffer holding the page */
+
+
+    for (i = 0; i < EDUOM_FSM_SIZE; i++) {
+        entry = &eduom_fsMap[i];
+        if (entry->valid && EQUAL_OBJECTID(entry->catObjForFile, *catObjForFile)) {
+            *map = entry;
+            return(eNOERROR);
+        }
+    }
+
+    /*@ miss: build the map in a free or victim entry */
+    for (i = 0; i < EDUOM_FSM_SIZE; i++)
+        if (!eduom_fsMap[i].valid) break;
+
+    if (i == EDUOM_FSM_SIZE) {
+        i = eduom_fsMapVictim;
+        eduom_fsMapVictim = (eduom_fsMapVictim + 1) % EDUOM_FSM_SIZE;
+    }
+
+    entry = &eduom_fsMap[i];
+    eduom_FreeMapEntry(entry);
+
+    entry->catObjForFile = *catObjForFile;
+    for (i = 0; i < EDUOM_FSM_NCLASSES; i++) entry->head[i] = NIL;
+    entry->valid = TRUE;
+
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) { eduom_FreeMapEntry(entry); ERR(e); }
+
+    lists[0] = catEntry->availSpaceList10;
+    lists[1] = catEntry->availSpaceList20;
+    lists[2] = catEntry->availSpaceList30;
+    lists[3] = catEntry->availSpaceList40;
+    lists[4] = catEntry->availSpaceList50;
+
+    for (i = 0; i < 5 && entry->valid; i++) {
+        MAKE_PAGEID(pid, catEntry->fid.volNo, lists[i]);
+
+        while (pid.pageNo != NIL && entry->valid) {
+            e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+            if (e < 0) { eduom_FreeMapEntry(entry); ERR(e); }
+
+            eduom_MapSetPage(entry, pid.pageNo, SP_FREE(apage));
+
+            e = BfM_FreeTrain(&pid, PAGE_BUF);
+            if (e < 0) { eduom_FreeMapEntry(entry); ERR(e); }
+
+            pid.pageNo = apage->header.spaceListNext;
+        }
+    }
+
+    if (entry->valid && catEntry->lastPage != NIL &&
+        (catEntry->lastPage >= entry->nPages || entry->next[catEntry->lastPage] == EDUOM_FSM_NOTIN)) {
+        MAKE_PAGEID(pid, catEntry->fid.volNo, catEntry->lastPage);
+        e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+        if (e < 0) { eduom_FreeMapEntry(entry); ERR(e); }
+
+        eduom_MapSetPage(entry, pid.pageNo, SP_FREE(apage));
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) { eduom_FreeMapEntry(entry); ERR(e); }
+    }
+
+    *map = (entry->valid) ? entry : NULL;
+
+    return(eNOERROR);
+
+} /* eduom_GetFreeSpaceMap() */
+
+
+
+/*@================================
+ * eduom_FindPageInFreeSpaceMap()
+ *================================*/
+/*
+ * Function: Four eduom_FindPageInFreeSpaceMap(ObjectID*, Four, PageNo*)
+ *
+ * Description :
+ *  Find the fullest page whose free space class guarantees 'needed' bytes
+ *  of free space. The caller must check the free space of the page since
+ *  the map is only a hint.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter pageNo
+ *     'pageNo' is set to the page found, or NIL if there is no such page
+ */
+Four eduom_FindPageInFreeSpaceMap(
+    ObjectID		*catObjForFile,	/* IN catalog object of the data file */
+    Four		needed,		/* IN free space needed */
+    PageNo		*pageNo)	/* OUT page found */
+{
+    Four		e;		/* error number */
+    Four		c;		/* free space class */
+    eduom_FreeSpaceMap	*map;		/* free space map of the file */
+
+
+    *pageNo = NIL;
+
+    e = eduom_GetFreeSpaceMap(catObjForFile, &map);
+    if (e < 0) ERR(e);
+
+    if (map == NULL) return(eNOERROR);
+
+    for (c = (needed + EDUOM_FSM_CLASSSIZE - 1) / EDUOM_FSM_CLASSSIZE; c < EDUOM_FSM_NCLASSES; c++)
+        if (map->head[c] != NIL) {
+            *pageNo = map->head[c];
+            break;
+        }
+
+    return(eNOERROR);
+
+} /* eduom_FindPageInFreeSpaceMap() */
+
+
+/*@================================
+ * eduom_FindPageInFreeSpaceMapRange()
+ *================================*/
+/*
+ * Function: Four eduom_FindPageInFreeSpaceMapRange(ObjectID*, Four, PageNo, Four, PageNo*)
+ *
+ * Description :
+ *  Find the fullest page among the 'nPages' pages starting from 'firstPage'
+ *  whose free space class guarantees 'needed' bytes of free space, e.g.
+ *  a page in the same extent as a given page. The caller must check the
+ *  free space of the page since the map is only a hint.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter pageNo
+ *     'pageNo' is set to the page found, or NIL if there is no such page
+ */
+Four eduom_FindPageInFreeSpaceMapRange(
+    ObjectID		*catObjForFile,	/* IN catalog object of the data file */
+    Four		needed,		/* IN free space needed */
+    PageNo		firstPage,	/* IN first page of the range */
+    Four		nPages,		/* IN # of pages in the range */
+    PageNo		*pageNo)	/* OUT page found */
+{
+    Four		e;		/* error number */
+    Four		c;		/* free space class of a page */
+    Four		minClass;	/* lowest class having 'needed' bytes */
+    Four		bestClass;	/* class of the page found */
+    PageNo		p;		/* page in the range */
+    eduom_FreeSpaceMap	*map;		/* free space map of the file */
+
+
+    *pageNo = NIL;
+
+    e = eduom_GetFreeSpaceMap(catObjForFile, &map);
+    if (e < 0) ERR(e);
+
+    if (map == NULL) return(eNOERROR);
+
+    minClass = (needed + EDUOM_FSM_CLASSSIZE - 1) / EDUOM_FSM_CLASSSIZE;
+    bestClass = EDUOM_FSM_NCLASSES;
+
+    for (p = firstPage; p < firstPage + nPages && p < map->nPages; p++) {
+        if (map->next[p] == EDUOM_FSM_NOTIN) continue;
+
+        c = FSM_GET_CLASS(map, p);
+        if (c >= minClass && c < bestClass) {
+            *pageNo = p;
+            bestClass = c;
+        }
+    }
+
+    return(eNOERROR);
+
+} /* eduom_FindPageInFreeSpaceMapRange() */
+
+
+
+/*@================================
+ * eduom_SetFreeSpaceMap()
+ *================================*/
+/*
+ * Function: Four eduom_SetFreeSpaceMap(ObjectID*, PageID*, Four)
+ *
+ * Description :
+ *  Record in the map that the page has 'freeSpace' bytes of free space.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_SetFreeSpaceMap(
+    ObjectID		*catObjForFile,	/* IN catalog object of the data file */
+    PageID		*pid,		/* IN page whose free space changed */
+    Four		freeSpace)	/* IN free space of the page */
+{
+    Four		e;		/* error number */
+    eduom_FreeSpaceMap	*map;		/* free space map of the file */
+
+
+    e = eduom_GetFreeSpaceMap(catObjForFile, &map);
+    if (e < 0) ERR(e);
+
+    if (map != NULL) eduom_MapSetPage(map, pid->pageNo, freeSpace);
+
+    return(eNOERROR);
+
+} /* eduom_SetFreeSpaceMap() */
+
+
+
+/*@================================
+ * eduom_ClearFreeSpaceMap()
+ *================================*/
+/*
+ * Function: Four eduom_ClearFreeSpaceMap(ObjectID*, PageID*)
+ *
+ * Description :
+ *  Remove the page from the map, e.g. when it is deallocated.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_ClearFreeSpaceMap(
+    ObjectID		*catObjForFile,	/* IN catalog object of the data file */
+    PageID		*pid)		/* IN page to remove */
+{
+    Four		e;		/* error number */
+    eduom_FreeSpaceMap	*map;		/* free space map of the file */
+
+
+    e = eduom_GetFreeSpaceMap(catObjForFile, &map);
+    if (e < 0) ERR(e);
+
+    if (map != NULL) eduom_MapRemovePage(map, pid->pageNo);
+
+    return(eNOERROR);
+
+} /* eduom_ClearFreeSpaceMap() */
+
+
+
+/*@================================
+ * eduom_DropFreeSpaceMap()
+ *================================*/
+/*
+ * Function: void eduom_DropFreeSpaceMap(ObjectID*)
+ *
+ * Description :
+ *  Discard the free space map of the data file, or all the maps if
+ *  'catObjForFile' is NULL.
+ */
+void eduom_DropFreeSpaceMap(
+    ObjectID		*catObjForFile)	/* IN catalog object of the data file */
+{
+    Four		i;		/* index variable */
+
+
+    for (i = 0; i < EDUOM_FSM_SIZE; i++)
+        if (eduom_fsMap[i].valid &&
+            (catObjForFile == NULL ||
+             EQUAL_OBJECTID(eduom_fsMap[i].catObjForFile, *catObjForFile)))
+            eduom_FreeMapEntry(&eduom_fsMap[i]);
+
+} /* eduom_DropFreeSpaceMap() */
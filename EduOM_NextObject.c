@@ -27,6 +27,9 @@
  *
  * Description:
  *  Return the next Object of the given Current Object. 
+ *  Only live objects are returned: empty slots and forwarding stubs are
+ *  skipped, and a moved object is returned with its original ObjectID.
+ *  eNOERROR means an object was found and EOS means the end of the file.
  *
  * Export:
  *  Four EduOM_NextObject(ObjectID*, ObjectID*, ObjectID*, ObjectHdr*)
@@ -51,9 +54,15 @@
  *  same page which has the current Object and  if there  is no next Object in
  *  the same page, find it from the next page. If the Current Object is NULL,
  *  return the first Object of the file.
+ *  Empty slots and forwarding stubs are skipped; a forwarded record is
+ *  returned with the ObjectID of its stub. Unlike the baseline EduOM, the
+ *  ObjectID of an empty slot is never returned, and a found object is
+ *  reported with eNOERROR rather than EOS.
  *
  * Returns:
  *  error code
+ *    eNOERROR : the next object was found
+ *    EOS : there is no next object in the file
  *    eBADCATALOGOBJECT_OM
  *    eBADOBJECTID_OM
  *    some errors caused by function calls
@@ -72,20 +81,12 @@ Four EduOM_NextObject(
 {
     Four e;			/* error */
     Two  i;			/* index */
-    Four offset;		/* starting offset of object within a page */
     PageID pid;			/* a page identifier */
     PageNo pageNo;		/* a temporary var for next page's PageNo */
     SlottedPage *apage;		/* a pointer to the data page */
     Object *obj;		/* a pointer to the Object */
-    PhysicalFileID pFid;	/* file in which the objects are located */
-    SlottedPage *catPage;	/* buffer page containing the catalog object */
-    sm_CatOverlayForData *catEntry; /* data structure for catalog object access */
-    PageID  nextpageID;
-    SlottedPage *nextpage;
-    PageID firstpid;
-    PageNo firstpageNo;
-    SlottedPage *firstpage;
-    PageID catpid;
+    ObjectID loc;		/* record holding the data of the current object */
+    sm_CatOverlayForData *catEntry; /* cached catalog information of the file */
 
 
     /*@
@@ -95,72 +96,62 @@ Four EduOM_NextObject(
     
     if (nextOID == NULL) ERR(eBADOBJECTID_OM);
     //파라미터로 주어진 curOID가 NULL인 경우
+    //File의 첫번째 page의 처음부터 탐색함
     if(curOID==NULL){
-        //File의 첫번째 page의 slot array 상에서의 첫번째 object ID를 반환함
-        //catpage에 대한 정보 지정
-        //catObjForFile이 들어있는 page를 catPage 포인터에 입력
-        //get train에서 오류발생
-        catpid.pageNo=catObjForFile->pageNo;
-        catpid.volNo=catObjForFile->volNo;
-        BfM_GetTrain(&catpid, (char **)&catPage, PAGE_BUF);
-        GET_PTR_TO_CATENTRY_FOR_DATA(catObjForFile, catPage, catEntry);
-
-        //catEntry에서 첫번째 page의 pageno 찾아 firstpageNo에 할당
-        firstpageNo=catEntry->firstPage;
-        //pageno와 catObjForFile의 volno 이용해서 마지막 page 포인터 firstpage에 할당
-        firstpid.pageNo = firstpageNo;
-        firstpid.volNo = catObjForFile->volNo;
-        BfM_GetTrain(&firstpid, (char **)&firstpage, PAGE_BUF);
-        //해당 포인터의 첫번째 object ID를 nextOID에 입력
-        nextOID->pageNo = firstpid.pageNo;
-        nextOID->volNo = firstpid.volNo;
-        nextOID->slotNo = 0;
-        nextOID->unique = firstpage->slot[0].unique;
-        objHdr=firstpage->data+firstpage->slot[0].offset;
-        BfM_FreeTrain(&catpid, PAGE_BUF);
-        BfM_FreeTrain(&firstpid, PAGE_BUF);
+        //catalog page를 읽는 대신 catalog cache를 이용함
+        e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+        if (e < 0) ERR(e);
+
+        MAKE_PAGEID(pid, catObjForFile->volNo, catEntry->firstPage);
+        e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        i = -1;
     }
-    //파라미터로 주어진 curOID가 NULL이 아닌 경우    
+    //파라미터로 주어진 curOID가 NULL이 아닌 경우
+    //curOID의 다음 slot부터 탐색함; 이동된 object는 forwarded record의 위치에서 계속함
     else{
-        pid.pageNo=curOID->pageNo;
-        pid.volNo=curOID->volNo;
-        BfM_GetTrain(&pid,(char **)&apage,PAGE_BUF);
-        //curOID에 대응하는 object를 탐색함
-        obj = apage->data + apage->slot[-(curOID->slotNo)].offset;
-        //Slot array 상에서, 탐색한 object의 다음 objet의 ID를 반환함
-        //탐색한 object가 page의 마지막 object인 경우
-        if(curOID->slotNo==apage->header.nSlots-1){
-            if(apage->header.nextPage==-1){
-                //탐색한 object가 file의 마지막 page의 마지막 object인 경우
-                //EOS를 반환
-                return EOS;
-            }
-            //다음 page의 첫번째 object의 ID를 반환
-            //다음 page의 포인터 필요
-            nextpageID.volNo=curOID->volNo;
-            nextpageID.pageNo=apage->header.nextPage;
-            BfM_GetTrain(&nextpageID, (char **)&nextpage, PAGE_BUF);
-            nextOID->pageNo = nextpageID.pageNo;
-            nextOID->volNo = nextpageID.volNo;
-            nextOID->slotNo = 0;
-            nextOID->unique = nextpage->slot[0].unique;
-            objHdr=nextpage->data+nextpage->slot[0].offset;
-            BfM_FreeTrain(&nextpageID, PAGE_BUF);
-        }
-        //마지막 object가 아닐 경우
-        else{
-            //obj(cur object)의 다음 object 반환
-            nextOID->pageNo=curOID->pageNo;
-            nextOID->volNo=curOID->volNo;
-            nextOID->slotNo=curOID->slotNo+1;
-            nextOID->unique=apage->slot[-(nextOID->slotNo)].unique;
-            objHdr=apage->data+apage->slot[-(nextOID->slotNo)].offset;
-        }
-        BfM_FreeTrain(&pid, PAGE_BUF);
+        MAKE_PAGEID(pid, curOID->volNo, curOID->pageNo);
+        e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        e = eduom_FollowForwarding(curOID, &pid, &apage, &loc);
+        if (e < 0) ERR(e);
+
+        i = loc.slotNo;
     }
 
+    //빈 slot과 forwarding stub은 건너뜀
+    //forwarded record는 원래의 ObjectID로 반환함
+    for ( ; ; ) {
+        for (i++; i < apage->header.nSlots; i++) {
+            if (apage->slot[-i].offset == EMPTYSLOT) continue;
+
+            obj = (Object *)&(apage->data[apage->slot[-i].offset]);
+            if (obj->header.properties & P_MOVED) continue;
+
+            eduom_GetLogicalObject(apage, i, nextOID, objHdr);
 
+            e = BfM_FreeTrain(&pid, PAGE_BUF);
+            if (e < 0) ERR(e);
 
-    return(EOS);		/* end of scan */
+            return(eNOERROR);
+        }
+
+        //page의 마지막 object까지 탐색한 경우 다음 page로 이동함
+        pageNo = apage->header.nextPage;
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        //file의 마지막 page인 경우 EOS를 반환
+        if (pageNo == NIL) return(EOS);
+
+        MAKE_PAGEID(pid, pid.volNo, pageNo);
+        e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        i = -1;
+    }
     
 } /* EduOM_NextObject() */
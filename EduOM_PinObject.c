@@ -0,0 +1,257 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_PinObject.c
+ * 
+ * Description : 
+ *  EduOM_PinObject() gives direct access to the object identified by 'oid'
+ *  in the buffer without copying it. The page holding the object is kept
+ *  fixed until EduOM_UnpinObject() is called.
+ *
+ *  Keeping the page fixed keeps it in the buffer, but does not keep the
+ *  object in its place in the page: creating, updating, appending to or
+ *  destroying an object, and reorganizing or collapsing the forwarding of
+ *  the file, may compact a page of the file and move the objects in it.
+ *  The caller must not do any of them on the file of a pinned object while
+ *  it uses the pointer. If EduOM is compiled with EDUOM_PIN_DEBUG, the
+ *  compaction of a pinned page is reported to the error log.
+ *
+ * Exports:
+ *  Four EduOM_PinObject(ObjectID*, const void**, Four*, PinHandle*)
+ *  Four EduOM_UnpinObject(PinHandle*)
+ *  Four EduOM_CheckPinLeaks(void)
+ *
+ * Internal Exports:
+ *  Boolean eduom_IsPinnedPage(PageID*)  (with EDUOM_PIN_DEBUG)
+ */
+
+
+#include "EduOM_common.h"
+#include "BfM.h"		/* for the buffer manager call */
+#include "EduOM_Internal.h"
+
+
+/* # of pins not yet released */
+Four eduom_nPins = 0;
+
+#ifdef EDUOM_PIN_DEBUG
+/* maximum # of pins tracked in the debug mode */
+#define EDUOM_MAXPINS	64
+
+/* pages fixed by EduOM_PinObject() and not yet released */
+static PageID eduom_pinnedPages[EDUOM_MAXPINS];
+#endif /* EDUOM_PIN_DEBUG */
+
+
+
+/*@================================
+ * EduOM_PinObject()
+ *================================*/
+/*
+ * Function: Four EduOM_PinObject(ObjectID*, const void**, Four*, PinHandle*)
+ * 
+ * Description : 
+ *  (1) What to do?
+ *  EduOM_PinObject() returns the pointer to the data of the object in the
+ *  buffer and its length. The data must not be modified through the pointer
+ *  and is valid until the handle is passed to EduOM_UnpinObject(), provided
+ *  that the file of the object is not modified in the meantime; a page
+ *  compacted by a modification of the file moves the object it holds.
+ *
+ *  (2) How to do?
+ *  a. Read in the slotted page
+ *  b. Validate the object identifier
+ *  c. Return the pointer into the data area keeping the page fixed
+ *
+ * Returns:
+ *  error code
+ *    eBADOBJECTID_OM
+ *    eBADUSERBUF_OM
+ *    eBADPARAMETER_OM
+ *    eNOTSUPPORTED_EDUOM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter ptr, len
+ *     'ptr' points to the object's data and 'len' is set to its length
+ *  2) parameter handle
+ *     'handle' records the fixed page
+ */
+Four EduOM_PinObject(
+    ObjectID 	*oid,		/* IN object to pin */
+    const void	**ptr,		/* OUT pointer to the data of the object */
+    Four	*len,		/* OUT length of the data */
+    PinHandle	*handle)	/* OUT handle to release the pin */
+{
+    Four     	e;              /* error code */
+    PageID 	pid;		/* page containing object specified by 'oid' */
+    SlottedPage	*apage;		/* pointer to the buffer of the page  */
+    Object	*obj;		/* pointer to the object in the slotted page */
+
+
+    /*@ check parameters */
+
+    if (oid == NULL) ERR(eBADOBJECTID_OM);
+
+    if (ptr == NULL || len == NULL) ERR(eBADUSERBUF_OM);
+
+    if (handle == NULL) ERR(eBADPARAMETER_OM);
+
+    /* a moved object is pinned in the page of its forwarded record */
+    e = eduom_FixObject(oid, &pid, &apage, &obj, NULL);
+    if (e < 0) ERR(e);
+
+    /* the data of a large object are not in the page */
+    if (obj->header.properties & P_LRGOBJ) ERRB1(eNOTSUPPORTED_EDUOM, &pid, PAGE_BUF);
+
+    *ptr = OBJ_DATA(obj);
+    *len = OBJ_LENGTH(obj);
+
+    handle->pid = pid;
+    handle->pinned = TRUE;
+
+    eduom_nPins++;
+
+#ifdef EDUOM_PIN_DEBUG
+    {
+        Four i;
+
+        for (i = 0; i < EDUOM_MAXPINS; i++)
+            if (eduom_pinnedPages[i].pageNo == 0 && eduom_pinnedPages[i].volNo == 0) break;
+
+        if (i < EDUOM_MAXPINS) eduom_pinnedPages[i] = pid;
+    }
+#endif /* EDUOM_PIN_DEBUG */
+
+    return(eNOERROR);
+    
+} /* EduOM_PinObject() */
+
+
+
+/*@================================
+ * EduOM_UnpinObject()
+ *================================*/
+/*
+ * Function: Four EduOM_UnpinObject(PinHandle*)
+ * 
+ * Description : 
+ *  Release the page fixed by EduOM_PinObject().
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_OM
+ *    some errors caused by function calls
+ */
+Four EduOM_UnpinObject(
+    PinHandle	*handle)	/* INOUT handle returned by EduOM_PinObject() */
+{
+    Four     	e;              /* error code */
+
+
+    if (handle == NULL || !handle->pinned) ERR(eBADPARAMETER_OM);
+
+    e = BfM_FreeTrain(&(handle->pid), PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    handle->pinned = FALSE;
+
+    eduom_nPins--;
+
+#ifdef EDUOM_PIN_DEBUG
+    {
+        Four i;
+
+        for (i = 0; i < EDUOM_MAXPINS; i++)
+            if (EQUAL_PAGEID(eduom_pinnedPages[i], handle->pid)) break;
+
+        if (i < EDUOM_MAXPINS) MAKE_PAGEID(eduom_pinnedPages[i], 0, 0);
+    }
+#endif /* EDUOM_PIN_DEBUG */
+
+    return(eNOERROR);
+    
+} /* EduOM_UnpinObject() */
+
+
+
+/*@================================
+ * EduOM_CheckPinLeaks()
+ *================================*/
+/*
+ * Function: Four EduOM_CheckPinLeaks(void)
+ * 
+ * Description : 
+ *  Return the number of the pins not yet released. It is to be called at
+ *  the end of a scan or a transaction, where no pin should remain.
+ *  If EduOM is compiled with EDUOM_PIN_DEBUG, the pages still fixed are
+ *  reported to the error log.
+ *
+ * Returns:
+ *  # of pins not yet released
+ */
+Four EduOM_CheckPinLeaks(void)
+{
+#ifdef EDUOM_PIN_DEBUG
+    Four i;
+
+    for (i = 0; i < EDUOM_MAXPINS; i++)
+        if (eduom_pinnedPages[i].pageNo != 0 || eduom_pinnedPages[i].volNo != 0)
+            Util_ErrorLog_Printf("Pin leak : page (%d, %d) is still fixed\n",
+                                 eduom_pinnedPages[i].volNo, eduom_pinnedPages[i].pageNo);
+#endif /* EDUOM_PIN_DEBUG */
+
+    return(eduom_nPins);
+    
+} /* EduOM_CheckPinLeaks() */
+
+
+
+#ifdef EDUOM_PIN_DEBUG
+/*@================================
+ * eduom_IsPinnedPage()
+ *================================*/
+/*
+ * Function: Boolean eduom_IsPinnedPage(PageID*)
+ * 
+ * Description : 
+ *  Check whether an object in the page is pinned.
+ *
+ * Returns:
+ *  TRUE if the page is fixed by EduOM_PinObject(), FALSE otherwise
+ */
+Boolean eduom_IsPinnedPage(
+    PageID	*pid)		/* IN page to check */
+{
+    Four i;
+
+
+    for (i = 0; i < EDUOM_MAXPINS; i++)
+        if (EQUAL_PAGEID(eduom_pinnedPages[i], *pid)) return(TRUE);
+
+    return(FALSE);
+    
+} /* eduom_IsPinnedPage() */
+#endif /* EDUOM_PIN_DEBUG */
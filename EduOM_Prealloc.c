@@ -0,0 +1,310 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_Prealloc.c
+ * 
+ * Description :
+ *  Allocate the pages of the data files. An operation which may need many
+ *  new pages of a file, e.g. EduOM_CreateObjects(), brackets its work with
+ *  eduom_BeginPreallocation() and eduom_EndPreallocation(). In between,
+ *  when the file needs a new page, the pages for one extent (as many as the
+ *  extent fill factor allows) are allocated by one call of
+ *  RDsM_AllocTrains() and the following requests are served from them as
+ *  long as the page is in the extent of the page the new page is to be
+ *  near; otherwise the pages left are returned and the pages for one extent
+ *  are allocated near that page, so that the placement of the new pages is
+ *  the same as without the preallocation. eduom_EndPreallocation() returns
+ *  the pages not used, so no page stays allocated but unused after the
+ *  operation. Outside such an operation a page is allocated at a time.
+ *
+ * Internal Exports:
+ *  Four eduom_AllocPage(ObjectID*, PageID*, PageID*)
+ *  void eduom_BeginPreallocation(ObjectID*)
+ *  Four eduom_EndPreallocation(ObjectID*)
+ *  void eduom_DropPreallocatedPages(ObjectID*)
+ */
+
+#include "EduOM_common.h"
+#include "RDsM.h"		/* for the raw disk manager call */
+#include "EduOM_Internal.h"
+
+
+/* number of data files whose pages are preallocated */
+#define EDUOM_PREALLOC_SIZE	16
+
+/* maximum number of pages preallocated at a time */
+#define EDUOM_PREALLOC_MAXPAGES	64
+
+/*
+ * Typedef for the pages preallocated for a data file
+ */
+typedef struct {
+	Boolean		valid;		/* TRUE if the entry holds pages */
+	ObjectID	catObjForFile;	/* catalog object of the data file */
+	Four		nPages;		/* # of pages preallocated */
+	Four		next;		/* index of the next page to hand out */
+	PageID		pids[EDUOM_PREALLOC_MAXPAGES]; /* preallocated pages */
+} eduom_PreallocEntry;
+
+static eduom_PreallocEntry eduom_prealloc[EDUOM_PREALLOC_SIZE];
+
+
+/* Macro: EQUAL_OBJECTID(x, y)
+ * Description: check whether the two object IDs are equal
+ */
+#define EQUAL_OBJECTID(x, y) \
+	(((x).volNo == (y).volNo && (x).pageNo == (y).pageNo && \
+	  (x).slotNo == (y).slotNo && (x).unique == (y).unique) ? TRUE : FALSE)
+
+
+
+/*@================================
+ * eduom_FreeEntryPages()
+ *================================*/
+/*
+ * Function: Four eduom_FreeEntryPages(eduom_PreallocEntry*)
+ *
+ * Description :
+ *  Return the pages not yet handed out to the raw disk manager and mark
+ *  the entry unused.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_FreeEntryPages(
+    eduom_PreallocEntry	*entry)		/* INOUT entry to release */
+{
+    Four		e;		/* error number */
+
+
+    entry->valid = FALSE;
+
+    for ( ; entry->next < entry->nPages; entry->next++) {
+        e = RDsM_FreeTrain(&(entry->pids[entry->next]), PAGESIZE2);
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* eduom_FreeEntryPages() */
+
+
+
+/*@================================
+ * eduom_AllocPage()
+ *================================*/
+/*
+ * Function: Four eduom_AllocPage(ObjectID*, PageID*, PageID*)
+ *
+ * Description :
+ *  Allocate a page for the data file near 'nearPid'. Within a
+ *  preallocation of the file, the page is taken from the pages
+ *  preallocated for the file if the next one is in the extent of 'nearPid';
+ *  if there is none left or it is in another extent, the pages left are
+ *  returned and the pages for one extent are allocated near 'nearPid'
+ *  first. Otherwise only the page is allocated.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter newPid
+ *     'newPid' is set to the page allocated
+ */
+Four eduom_AllocPage(
+    ObjectID		*catObjForFile,	/* IN catalog object of the data file */
+    PageID		*nearPid,	/* IN allocate the pages near this page */
+    PageID		*newPid)	/* OUT page allocated */
+{
+    Four		e;		/* error number */
+    Four		i;		/* index variable */
+    Four		firstExt;	/* first extent of the file */
+    Two			sizeOfExt;	/* # of pages in an extent */
+    Four		nPages;		/* # of pages to preallocate */
+    Four		nearExt;	/* extent of the near page */
+    Four		poolExt;	/* extent of the next preallocated page */
+    PhysicalFileID	pFid;		/* physical ID of the file */
+    eduom_PreallocEntry	*entry;		/* entry of the file */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+
+
+    for (i = 0; i < EDUOM_PREALLOC_SIZE; i++) {
+        entry = &eduom_prealloc[i];
+        if (entry->valid && EQUAL_OBJECTID(entry->catObjForFile, *catObjForFile)) break;
+    }
+
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) ERR(e);
+
+    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
+    e = RDsM_PageIdToExtNo((PageID *)&pFid, &firstExt);
+    if (e < 0) ERR(e);
+
+    if (i == EDUOM_PREALLOC_SIZE) {
+        /*@ not within a preallocation; allocate the page only */
+        e = RDsM_AllocTrains(catEntry->fid.volNo, firstExt, nearPid, catEntry->eff,
+                             1, PAGESIZE2, newPid);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    if (entry->next < entry->nPages) {
+        /*@ the next preallocated page must be in the extent of the near page */
+        e = RDsM_PageIdToExtNo(nearPid, &nearExt);
+        if (e < 0) ERR(e);
+
+        e = RDsM_PageIdToExtNo(&(entry->pids[entry->next]), &poolExt);
+        if (e < 0) ERR(e);
+
+        if (poolExt != nearExt) {
+            e = eduom_FreeEntryPages(entry);
+            if (e < 0) ERR(e);
+
+            entry->valid = TRUE;
+        }
+    }
+
+    if (entry->next == entry->nPages) {
+        /*@ preallocate the pages for one extent */
+        e = RDsM_GetSizeOfExt(catEntry->fid.volNo, &sizeOfExt);
+        if (e < 0) ERR(e);
+
+        nPages = sizeOfExt * catEntry->eff / 100;
+        if (nPages < 1) nPages = 1;
+        if (nPages > EDUOM_PREALLOC_MAXPAGES) nPages = EDUOM_PREALLOC_MAXPAGES;
+
+        e = RDsM_AllocTrains(catEntry->fid.volNo, firstExt, nearPid, catEntry->eff,
+                             nPages, PAGESIZE2, entry->pids);
+        if (e < 0) ERR(e);
+
+        entry->nPages = nPages;
+        entry->next = 0;
+    }
+
+    *newPid = entry->pids[entry->next++];
+
+    return(eNOERROR);
+
+} /* eduom_AllocPage() */
+
+
+
+/*@================================
+ * eduom_BeginPreallocation()
+ *================================*/
+/*
+ * Function: void eduom_BeginPreallocation(ObjectID*)
+ *
+ * Description :
+ *  Start preallocating the pages of the data file. If the pages of
+ *  EDUOM_PREALLOC_SIZE files are being preallocated already, the pages of
+ *  the file are allocated one at a time as before.
+ */
+void eduom_BeginPreallocation(
+    ObjectID		*catObjForFile)	/* IN catalog object of the data file */
+{
+    Four		i;		/* index variable */
+    eduom_PreallocEntry	*entry;		/* entry of the file */
+
+
+    for (i = 0; i < EDUOM_PREALLOC_SIZE; i++)
+        if (eduom_prealloc[i].valid &&
+            EQUAL_OBJECTID(eduom_prealloc[i].catObjForFile, *catObjForFile)) return;
+
+    for (i = 0; i < EDUOM_PREALLOC_SIZE; i++)
+        if (!eduom_prealloc[i].valid) break;
+
+    if (i == EDUOM_PREALLOC_SIZE) return;
+
+    entry = &eduom_prealloc[i];
+    entry->catObjForFile = *catObjForFile;
+    entry->nPages = 0;
+    entry->next = 0;
+    entry->valid = TRUE;
+
+} /* eduom_BeginPreallocation() */
+
+
+
+/*@================================
+ * eduom_EndPreallocation()
+ *================================*/
+/*
+ * Function: Four eduom_EndPreallocation(ObjectID*)
+ *
+ * Description :
+ *  Stop preallocating the pages of the data file and return the pages
+ *  preallocated but not used.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_EndPreallocation(
+    ObjectID		*catObjForFile)	/* IN catalog object of the data file */
+{
+    Four		e;		/* error number */
+    Four		i;		/* index variable */
+
+
+    for (i = 0; i < EDUOM_PREALLOC_SIZE; i++)
+        if (eduom_prealloc[i].valid &&
+            EQUAL_OBJECTID(eduom_prealloc[i].catObjForFile, *catObjForFile)) {
+            e = eduom_FreeEntryPages(&eduom_prealloc[i]);
+            if (e < 0) ERR(e);
+        }
+
+    return(eNOERROR);
+
+} /* eduom_EndPreallocation() */
+
+
+
+/*@================================
+ * eduom_DropPreallocatedPages()
+ *================================*/
+/*
+ * Function: void eduom_DropPreallocatedPages(ObjectID*)
+ *
+ * Description :
+ *  Forget the pages preallocated for the data file without returning them,
+ *  e.g. when the file has been destroyed together with its pages. If
+ *  'catObjForFile' is NULL, the pages of all the files are forgotten.
+ */
+void eduom_DropPreallocatedPages(
+    ObjectID		*catObjForFile)	/* IN catalog object of the data file */
+{
+    Four		i;		/* index variable */
+
+
+    for (i = 0; i < EDUOM_PREALLOC_SIZE; i++)
+        if (catObjForFile == NULL ||
+            EQUAL_OBJECTID(eduom_prealloc[i].catObjForFile, *catObjForFile))
+            eduom_prealloc[i].valid = FALSE;
+
+} /* eduom_DropPreallocatedPages() */
@@ -27,6 +27,9 @@
  *
  * Description: 
  *  Return the previous object of the given current object.
+ *  Only live objects are returned: empty slots and forwarding stubs are
+ *  skipped, and a moved object is returned with its original ObjectID.
+ *  eNOERROR means an object was found and EOS means the start of the file.
  *
  * Exports:
  *  Four EduOM_PrevObject(ObjectID*, ObjectID*, ObjectID*, ObjectHdr*)
@@ -51,9 +54,15 @@
  *  the same page which has the current object and  if there  is no previous
  *  object in the same page, find it from the previous page.
  *  If the current object is NULL, return the last object of the file.
+ *  Empty slots and forwarding stubs are skipped; a forwarded record is
+ *  returned with the ObjectID of its stub. Unlike the baseline EduOM, the
+ *  ObjectID of an empty slot is never returned, and a found object is
+ *  reported with eNOERROR rather than EOS.
  *
  * Returns:
  *  error code
+ *    eNOERROR : the previous object was found
+ *    EOS : there is no previous object in the file
  *    eBADCATALOGOBJECT_OM
  *    eBADOBJECTID_OM
  *    some errors caused by function calls
@@ -72,19 +81,12 @@ Four EduOM_PrevObject(
 {
     Four e;			/* error */
     Two  i;			/* index */
-    Four offset;		/* starting offset of object within a page */
     PageID pid;			/* a page identifier */
     PageNo pageNo;		/* a temporary var for previous page's PageNo */
     SlottedPage *apage;		/* a pointer to the data page */
     Object *obj;		/* a pointer to the Object */
-    SlottedPage *catPage;	/* buffer page containing the catalog object */
-    sm_CatOverlayForData *catEntry; /* overlay structure for catalog object access */
-    PageID  prevpageID;
-    SlottedPage *prevpage;
-    PageID lastpid;
-    PageNo lastpageNo;
-    SlottedPage *lastpage;
-    PageID catpid;
+    ObjectID loc;		/* record holding the data of the current object */
+    sm_CatOverlayForData *catEntry; /* cached catalog information of the file */
 
 
     /*@ parameter checking */
@@ -93,72 +95,62 @@ Four EduOM_PrevObject(
     if (prevOID == NULL) ERR(eBADOBJECTID_OM);
 
     //파라미터로 주어진 curOID가 NULL인 경우
+    //File의 마지막 page의 끝부터 탐색함
     if(curOID==NULL){
-        //File의 마지막 page의 slot array 상에서의 마지막 object ID를 반환함
-        //catpage에 대한 정보 지정
-        //catObjForFile이 들어있는 page를 catPage 포인터에 입력
-        //get train에서 오류발생
-        catpid.pageNo=catObjForFile->pageNo;
-        catpid.volNo=catObjForFile->volNo;
-        BfM_GetTrain(&catpid, (char **)&catPage, PAGE_BUF);
-        GET_PTR_TO_CATENTRY_FOR_DATA(catObjForFile, catPage, catEntry);
-
-        //catEntry에서 마지막 page의 pageno 찾아 lastpageNo에 할당
-        lastpageNo=catEntry->lastPage;
-        //pageno와 catObjForFile의 volno 이용해서 마지막 page 포인터 lastpage에 할당
-        lastpid.pageNo = lastpageNo;
-        lastpid.volNo = catObjForFile->volNo;
-        BfM_GetTrain(&lastpid, (char **)&lastpage, PAGE_BUF);
-        //해당 포인터의 마지막 object ID를 prevOID에 입력
-        prevOID->pageNo = lastpid.pageNo;
-        prevOID->volNo = lastpid.volNo;
-        prevOID->slotNo = lastpage->header.nSlots-1;
-        prevOID->unique = lastpage->slot[-(prevOID->slotNo)].unique;
-        // objHdr=lastpage->data + lastpage->slot[-(prevOID->slotNo)].offset;
-        BfM_FreeTrain(&catpid, PAGE_BUF);
-        BfM_FreeTrain(&lastpid, PAGE_BUF);
+        //catalog page를 읽는 대신 catalog cache를 이용함
+        e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+        if (e < 0) ERR(e);
 
+        MAKE_PAGEID(pid, catObjForFile->volNo, catEntry->lastPage);
+        e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        i = apage->header.nSlots;
     }
-    //파라미터로 주어진 curOID가 NULL이 아닌 경우    
+    //파라미터로 주어진 curOID가 NULL이 아닌 경우
+    //curOID의 이전 slot부터 탐색함; 이동된 object는 forwarded record의 위치에서 계속함
     else{
-        pid.pageNo=curOID->pageNo;
-        pid.volNo=curOID->volNo;
-        BfM_GetTrain(&pid,(char **)&apage,PAGE_BUF);
-        //curOID에 대응하는 object를 탐색함
-        obj = apage->data + apage->slot[-(curOID->slotNo-1)].offset;
-        //Slot array 상에서, 탐색한 object의 이전 objet의 ID를 반환함
-        //탐색한 object가 page의 첫번째 object인 경우
-        if(curOID->slotNo==0){
-            if(apage->header.prevPage==-1){
-                //탐색한 object가 file의 첫번째 page의 첫번째 object인 경우
-                //EOS를 반환
-                BfM_FreeTrain(&pid, PAGE_BUF);
-                return EOS;
-            }
-            //이전 page의 마지막 object의 ID를 반환
-            //이전 page의 포인터 필요
-            prevpageID.volNo=curOID->volNo;
-            prevpageID.pageNo=apage->header.prevPage;
-            BfM_GetTrain(&prevpageID, (char **)&prevpage, PAGE_BUF);
-            prevOID->pageNo = prevpageID.pageNo;
-            prevOID->volNo = prevpageID.volNo;
-            prevOID->slotNo = prevpage->header.nSlots-1;
-            prevOID->unique = prevpage->slot[-(prevOID->slotNo)].unique;
-            objHdr=prevpage->data+prevpage->slot[-(prevOID->slotNo)].offset;
-            BfM_FreeTrain(&prevpageID,PAGE_BUF);
-        }
-        //첫번째 object가 아닐 경우
-        else{
-            //obj(cur object)의 이전 object 반환
-            prevOID->pageNo=curOID->pageNo;
-            prevOID->volNo=curOID->volNo;
-            prevOID->slotNo=curOID->slotNo-1;
-            prevOID->unique=apage->slot[-(prevOID->slotNo)].unique;
-            objHdr=apage->data+apage->slot[-(prevOID->slotNo)].offset;
-        }
-        BfM_FreeTrain(&pid, PAGE_BUF);
+        MAKE_PAGEID(pid, curOID->volNo, curOID->pageNo);
+        e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        e = eduom_FollowForwarding(curOID, &pid, &apage, &loc);
+        if (e < 0) ERR(e);
+
+        i = loc.slotNo;
     }
 
-    return(EOS);
+    //빈 slot과 forwarding stub은 건너뜀
+    //forwarded record는 원래의 ObjectID로 반환함
+    for ( ; ; ) {
+        for (i--; i >= 0; i--) {
+            if (apage->slot[-i].offset == EMPTYSLOT) continue;
+
+            obj = (Object *)&(apage->data[apage->slot[-i].offset]);
+            if (obj->header.properties & P_MOVED) continue;
+
+            eduom_GetLogicalObject(apage, i, prevOID, objHdr);
+
+            e = BfM_FreeTrain(&pid, PAGE_BUF);
+            if (e < 0) ERR(e);
+
+            return(eNOERROR);
+        }
+
+        //page의 첫번째 object까지 탐색한 경우 이전 page로 이동함
+        pageNo = apage->header.prevPage;
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        //file의 첫번째 page인 경우 EOS를 반환
+        if (pageNo == NIL) return(EOS);
+
+        MAKE_PAGEID(pid, pid.volNo, pageNo);
+        e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        i = apage->header.nSlots;
+    }
     
 } /* EduOM_PrevObject() */
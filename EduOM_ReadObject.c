@@ -96,8 +96,7 @@ Four EduOM_ReadObject(
     PageID 	pid;		/* page containing object specified by 'oid' */
     SlottedPage	*apage;		/* pointer to the buffer of the page  */
     Object	*obj;		/* pointer to the object in the slotted page */
-    Four	offset;		/* offset of the object in the page */
-    Four    i;
+    ObjectID	loc;		/* record holding the data of the object */
 
     
     
@@ -109,28 +108,33 @@ Four EduOM_ReadObject(
     
     if (buf == NULL) ERR(eBADUSERBUF_OM);
 
+    if (start < 0) ERR(eBADSTART_OM);
+
     //파라미터로 주어진 oid를 이용하여 object에 접근함
-    pid.pageNo=oid->pageNo;
-    pid.volNo=oid->volNo;
-    BfM_GetTrain(&pid,(char **)&apage,PAGE_BUF);
-    //삭제할 object에 대응하는 Slot을 찾음
-    for(i=0;i<apage->header.nSlots;i++){
-        if(apage->slot[-i].unique==oid->unique){
-            offset=apage->slot[-i].offset;
-            break;
-        }
-    }
-    obj=apage->data + offset;
+    //이동된 object이면 forwarding stub을 따라가서 forwarded record를 읽음
+    e = eduom_FixObject(oid, &pid, &apage, &obj, &loc);
+    if (e < 0) ERR(e);
+
     //파라미터로 주어진 start 및 length를 고려하여 접근한 object의 데이터를 읽음
-    //object의 데이터 영역 상에서 start에 대응하는 offset에서 부터 length만큼의 데이터를 읽음
-    //length가 REMAINDER인 경우, 데이터를 끝까지 읽음
-    if(length==REMAINDER){
-        length=obj->header.length;
-    }
-    for(i=0;i<length;i++){
-            buf[i]=obj->data[start+i];
+    //length가 REMAINDER인 경우, start부터 데이터를 끝까지 읽음
+    if (start > OBJ_LENGTH(obj)) ERRB1(eBADSTART_OM, &pid, PAGE_BUF);
+
+    if (length == REMAINDER)
+        length = OBJ_LENGTH(obj) - start;
+    else if (start + length > OBJ_LENGTH(obj))
+        ERRB1(eBADLENGTH_OM, &pid, PAGE_BUF);
+
+    //large object의 데이터는 LOT가 읽음
+    if (obj->header.properties & P_LRGOBJ) {
+        e = LOT_ReadObject(&pid, loc.slotNo, start, length, buf);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
     }
-    BfM_FreeTrain(&pid, PAGE_BUF);
+    else
+        memcpy(buf, &(OBJ_DATA(obj)[start]), length);
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
     return(length);
     
 } /* EduOM_ReadObject() */
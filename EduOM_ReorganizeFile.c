@@ -0,0 +1,484 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_ReorganizeFile.c
+ * 
+ * Description : 
+ *  Reorganize a data file whose pages have become sparse after many
+ *  deletions. The objects of sparse pages are moved into the preceding
+ *  pages of the file, leaving forwarding stubs so that their ObjectIDs stay
+ *  valid. Emptied pages are deallocated, and pages left holding only stubs
+ *  are taken out of the page list of the file, so that a scan reads fewer
+ *  pages. The file is reorganized in place while it stays usable.
+ *  Forwarded records are moved back to their original slots in small steps
+ *  when room becomes available there.
+ *
+ * Exports:
+ *  Four EduOM_ReorganizeFile(ObjectID*, Four, Pool*, DeallocListElem*, EduOM_ReorgResult*)
+ *  Four EduOM_CollapseForwarding(ObjectID*, PageNo*, Four, Four*)
+ */
+
+
+#include <string.h>
+#include "EduOM_common.h"
+#include "Util.h"		/* to get Pool */
+#include "BfM.h"		/* for the buffer manager call */
+#include "EduOM_Internal.h"
+
+
+/* Macro: REORG_USED(p)
+ * Description: # of bytes of the data area in use
+ */
+#define REORG_USED(p)	(PAGESIZE - SP_FIXED - SP_FREE(p))
+
+
+
+/*@================================
+ * eduom_ReorgUnlinkPage()
+ *================================*/
+/*
+ * Function: Four eduom_ReorgUnlinkPage(ObjectID*, PageID*, SlottedPage*, Four)
+ *
+ * Description :
+ *  Take the page out of the available space lists and the page list of
+ *  the file. The caller must set the page dirty.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_ReorgUnlinkPage(
+    ObjectID		*catObjForFile,	/* IN file containing the page */
+    PageID		*pid,		/* IN page to unlink */
+    SlottedPage		*apage,		/* INOUT buffer holding the page */
+    Four		freeSpace)	/* IN free space when the page was put */
+{
+    Four		e;		/* error number */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+
+
+    e = eduom_RemoveFromAvailSpaceList(catObjForFile, pid, apage, freeSpace);
+    if (e < 0) ERR(e);
+
+    e = om_FileMapDeletePage(catObjForFile, pid);
+    if (e < 0) ERR(e);
+
+    /* om_FileMapDeletePage() updates the catalog page directly */
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) ERR(e);
+
+    e = eduom_RefreshCatalogEntry(catObjForFile, catEntry);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* eduom_ReorgUnlinkPage() */
+
+
+
+/*@================================
+ * EduOM_ReorganizeFile()
+ *================================*/
+/*
+ * Function: Four EduOM_ReorganizeFile(ObjectID*, Four, Pool*, DeallocListElem*, EduOM_ReorgResult*)
+ *
+ * Description :
+ *  (1) What to do?
+ *  EduOM_ReorganizeFile() merges the pages of the file which are filled
+ *  less than 'targetFill' percent. The objects are moved into the
+ *  preceding pages while those pages stay filled at most 'targetFill'
+ *  percent. A moved object leaves a forwarding stub in its original slot;
+ *  a forwarded record moved again gets its stub updated. Large objects are
+ *  not moved. The pages freed are added to the dealloc list.
+ *
+ *  The number of pages read by a scan of the file drops from
+ *  'nPagesBefore' to 'nPagesAfter' of the result.
+ *
+ *  (2) How to do?
+ *  a. Walk the page list of the file from the second page
+ *  b. IF the page is filled at least 'targetFill' percent THEN
+ *         it becomes the destination page of the following pages
+ *     ELSE
+ *         move its objects into the destination page while they fit
+ *         IF no object is left THEN
+ *             deallocate the page (with no stub) or unlink it (with stubs)
+ *         ELSE
+ *             the page becomes the destination page
+ *         ENDIF
+ *     ENDIF
+ *
+ * Returns:
+ *  error code
+ *    eBADCATALOGOBJECT_OM
+ *    eBADPARAMETER_OM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter dlHead
+ *     the deallocated pages are added to the dealloc list
+ *  2) parameter result
+ *     'result' is filled with the numbers of pages and objects
+ */
+Four EduOM_ReorganizeFile(
+    ObjectID		*catObjForFile,	/* IN file to reorganize */
+    Four		targetFill,	/* IN % of a page to fill */
+    Pool		*dlPool,	/* INOUT pool of dealloc list elements */
+    DeallocListElem	*dlHead,	/* INOUT head of dealloc list */
+    EduOM_ReorgResult	*result)	/* OUT result of the reorganization */
+{
+    Four		e;		/* error number */
+    Two			i;		/* slot index */
+    Four		limit;		/* # of bytes a page is filled up to */
+    PageNo		pageNo;		/* page to reorganize */
+    PageNo		nextPageNo;	/* next page of the page */
+    PageID		pid;		/* page to reorganize */
+    SlottedPage		*apage;		/* buffer holding the page */
+    Four		freeSpace;	/* free space of the page before */
+    PageID		dstPid;		/* destination page */
+    SlottedPage		*dstPage;	/* buffer holding the destination page */
+    Four		dstFreeSpace;	/* free space of the destination page before */
+    Boolean		dstFull;	/* TRUE if the destination page is full */
+    Object		*obj;		/* a record in the page */
+    ObjectID		newOid;		/* forwarded record */
+    Four		neededSpace;	/* space needed in the destination page */
+    Four		extraSpace;	/* space needed to enlarge an object into a stub */
+    Boolean		hasObject;	/* TRUE if objects are left in the page */
+    Boolean		hasStub;	/* TRUE if stubs are left in the page */
+    Boolean		forwarded;	/* TRUE if the object is a forwarded record */
+    DeallocListElem	*dlElem;	/* element of dealloc list */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+
+
+    /*@ check parameters */
+    if (catObjForFile == NULL) ERR(eBADCATALOGOBJECT_OM);
+
+    if (targetFill <= 0 || targetFill > 100 || dlPool == NULL || dlHead == NULL || result == NULL)
+        ERR(eBADPARAMETER_OM);
+
+    memset(result, 0, sizeof(EduOM_ReorgResult));
+
+    limit = (PAGESIZE - SP_FIXED) * targetFill / 100;
+
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) ERR(e);
+
+    /*@ the first page is never moved; it is the first destination */
+    MAKE_PAGEID(dstPid, catEntry->fid.volNo, catEntry->firstPage);
+    e = BfM_GetTrain(&dstPid, (char **)&dstPage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    pageNo = dstPage->header.nextPage;
+    result->nPagesBefore++;
+
+    e = BfM_FreeTrain(&dstPid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    for ( ; pageNo != NIL; pageNo = nextPageNo) {
+
+        MAKE_PAGEID(pid, dstPid.volNo, pageNo);
+        e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        result->nPagesBefore++;
+        nextPageNo = apage->header.nextPage;
+
+        if (REORG_USED(apage) >= limit) {
+            /* a dense page is kept as it is */
+            dstPid = pid;
+
+            e = BfM_FreeTrain(&pid, PAGE_BUF);
+            if (e < 0) ERR(e);
+
+            continue;
+        }
+
+        e = BfM_GetTrain(&dstPid, (char **)&dstPage, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        freeSpace = SP_FREE(apage);
+        dstFreeSpace = SP_FREE(dstPage);
+        dstFull = FALSE;
+        hasObject = hasStub = FALSE;
+
+        /*@ move the objects into the destination page */
+        for (i = 0; i < apage->header.nSlots; i++) {
+            if (apage->slot[-i].offset == EMPTYSLOT) continue;
+
+            obj = (Object *)&(apage->data[apage->slot[-i].offset]);
+
+            if (obj->header.properties & P_MOVED) {
+                hasStub = TRUE;
+                continue;
+            }
+
+            /* a large object stays in its page */
+            if (obj->header.properties & P_LRGOBJ) {
+                hasObject = TRUE;
+                continue;
+            }
+
+            /* relocating may compact this page, so 'obj' is not used after it */
+            forwarded = (obj->header.properties & P_FORWARDED) ? TRUE : FALSE;
+
+            if (forwarded) {
+                neededSpace = sizeof(ObjectHdr) + ALIGNED_LENGTH(obj->header.length) + sizeof(SlottedPageSlot);
+                extraSpace = 0;
+            } else {
+                neededSpace = sizeof(ObjectHdr) + ALIGNED_LENGTH(obj->header.length + FWD_BACKPTR_LEN) + sizeof(SlottedPageSlot);
+                extraSpace = ALIGNED_LENGTH(FWD_BACKPTR_LEN) - ALIGNED_LENGTH(obj->header.length);
+            }
+
+            if (!dstFull && (REORG_USED(dstPage) + neededSpace > limit || SP_FREE(dstPage) < neededSpace))
+                dstFull = TRUE;
+
+            if (dstFull || (extraSpace > 0 && SP_FREE(apage) < extraSpace)) {
+                hasObject = TRUE;
+                continue;
+            }
+
+            e = eduom_RelocateObject(&pid, apage, i, dstPage, &newOid);
+            if (e < 0) ERRB2(e, &pid, PAGE_BUF, &dstPid, PAGE_BUF);
+
+            /* a record moved for the first time leaves a stub here */
+            if (!forwarded) hasStub = TRUE;
+
+            result->nObjectsMoved++;
+        }
+
+        if (SP_FREE(dstPage) != dstFreeSpace) {
+            e = eduom_UpdateAvailSpaceList(catObjForFile, &dstPid, dstPage, dstFreeSpace);
+            if (e < 0) ERRB2(e, &pid, PAGE_BUF, &dstPid, PAGE_BUF);
+
+            e = eduom_SetDirty(&dstPid, PAGE_BUF);
+            if (e < 0) ERRB2(e, &pid, PAGE_BUF, &dstPid, PAGE_BUF);
+        }
+
+        e = BfM_FreeTrain(&dstPid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        if (hasObject) {
+            /* the objects left stay here; fill this page next */
+            e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+            dstPid = pid;
+
+        } else {
+            e = eduom_ReorgUnlinkPage(catObjForFile, &pid, apage, freeSpace);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+            if (hasStub) {
+                /* keep the stubs; the page is freed with its last stub */
+                apage->header.flags |= SP_STUBPAGE;
+                apage->header.nextPage = NIL;
+                apage->header.prevPage = NIL;
+
+                result->nPagesUnlinked++;
+
+            } else {
+                Util_getElementFromPool(dlPool, &dlElem);
+                dlElem->type = DL_PAGE;
+                dlElem->elem.pid = pid;
+                dlElem->next = dlHead->next;
+                dlHead->next = dlElem;
+
+                result->nPagesFreed++;
+            }
+        }
+
+        e = eduom_SetDirty(&pid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    result->nPagesAfter = result->nPagesBefore - result->nPagesFreed - result->nPagesUnlinked;
+
+    return(eNOERROR);
+
+} /* EduOM_ReorganizeFile() */
+
+
+
+/*@================================
+ * EduOM_CollapseForwarding()
+ *================================*/
+/*
+ * Function: Four EduOM_CollapseForwarding(ObjectID*, PageNo*, Four, Four*)
+ *
+ * Description :
+ *  (1) What to do?
+ *  EduOM_CollapseForwarding() moves forwarded records back into the slots
+ *  of their stubs when the pages of the stubs have room for them again, so
+ *  that the objects are read without the hop. Stubs in pages taken out of
+ *  the page list are left as they are.
+ *
+ *  At most 'maxPages' pages of the page list are processed per call,
+ *  starting from the page '*pageNo' (NIL means the first page), so that the
+ *  work can be spread over idle periods. '*pageNo' is set to the page to
+ *  continue from, or NIL when the end of the file is reached.
+ *
+ *  EduOM_CollapseForwarding() never frees a page. A page whose records
+ *  were all moved back stays in the page list, empty, until the caller
+ *  runs EduOM_ReorganizeFile() with a 'targetFill' above the use left in
+ *  the page; only then is the page deallocated. The first page of the file
+ *  is never freed.
+ *
+ *  (2) How to do?
+ *  a. For each forwarded record in the page
+ *  b.     IF the page of its stub has enough free space THEN
+ *             enlarge the stub into the object and remove the record
+ *         ENDIF
+ *
+ * Returns:
+ *  error code
+ *    eBADCATALOGOBJECT_OM
+ *    eBADPARAMETER_OM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter pageNo
+ *     '*pageNo' is set to the page to continue from or NIL
+ *  2) parameter nCollapsed
+ *     '*nCollapsed' is set to the # of objects moved back
+ */
+Four EduOM_CollapseForwarding(
+    ObjectID		*catObjForFile,	/* IN file to process */
+    PageNo		*pageNo,	/* INOUT page to start from */
+    Four		maxPages,	/* IN maximum # of pages to process */
+    Four		*nCollapsed)	/* OUT # of objects moved back */
+{
+    Four		e;		/* error number */
+    Two			i;		/* slot index */
+    Four		n;		/* # of pages processed */
+    PageID		pid;		/* page to process */
+    SlottedPage		*apage;		/* buffer holding the page */
+    Four		freeSpace;	/* free space of the page before */
+    Object		*obj;		/* a forwarded record in the page */
+    ObjectID		stubOid;	/* the stub of the record */
+    PageID		stubPid;	/* page holding the stub */
+    SlottedPage		*stubPage;	/* buffer holding the page */
+    Four		stubFreeSpace;	/* free space of the page before */
+    Object		*stub;		/* the stub */
+    Four		length;		/* length of the user data */
+    Boolean		modified;	/* TRUE if the page is modified */
+    sm_CatOverlayForData *catEntry;	/* cached catalog information */
+    char		buf[PAGESIZE];	/* the user data of the record */
+
+
+    /*@ check parameters */
+    if (catObjForFile == NULL) ERR(eBADCATALOGOBJECT_OM);
+
+    if (pageNo == NULL || maxPages <= 0 || nCollapsed == NULL) ERR(eBADPARAMETER_OM);
+
+    *nCollapsed = 0;
+
+    if (*pageNo == NIL) {
+        e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+        if (e < 0) ERR(e);
+
+        *pageNo = catEntry->firstPage;
+    }
+
+    for (n = 0; n < maxPages && *pageNo != NIL; n++) {
+
+        MAKE_PAGEID(pid, catObjForFile->volNo, *pageNo);
+        e = BfM_GetTrain(&pid, (char **)&apage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        freeSpace = SP_FREE(apage);
+        modified = FALSE;
+
+        for (i = 0; i < apage->header.nSlots; i++) {
+            if (apage->slot[-i].offset == EMPTYSLOT) continue;
+
+            obj = (Object *)&(apage->data[apage->slot[-i].offset]);
+            if (!(obj->header.properties & P_FORWARDED)) continue;
+
+            memcpy(&stubOid, obj->data, sizeof(ObjectID));
+
+            MAKE_PAGEID(stubPid, stubOid.volNo, stubOid.pageNo);
+            e = BfM_GetTrain(&stubPid, (char **)&stubPage, PAGE_BUF);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+            stub = (Object *)&(stubPage->data[stubPage->slot[-(stubOid.slotNo)].offset]);
+            length = OBJ_LENGTH(obj);
+
+            if ((stubPage->header.flags & SP_STUBPAGE) ||
+                ALIGNED_LENGTH(length) - ALIGNED_LENGTH(stub->header.length) > SP_FREE(stubPage)) {
+                e = BfM_FreeTrain(&stubPid, PAGE_BUF);
+                if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+                continue;
+            }
+
+            /*@ enlarge the stub into the object */
+            stubFreeSpace = SP_FREE(stubPage);
+            memcpy(buf, OBJ_DATA(obj), length);
+
+            e = eduom_ResizeInPage(stubPage, stubOid.slotNo, length);
+            if (e < 0) ERRB2(e, &stubPid, PAGE_BUF, &pid, PAGE_BUF);
+
+            stub = (Object *)&(stubPage->data[stubPage->slot[-(stubOid.slotNo)].offset]);
+            stub->header.properties &= ~P_MOVED;
+            memcpy(stub->data, buf, length);
+
+            e = eduom_RemoveFromPage(apage, i);
+            if (e < 0) ERRB2(e, &stubPid, PAGE_BUF, &pid, PAGE_BUF);
+
+            /* the page being processed is moved in the lists at the end */
+            if (!EQUAL_PAGEID(stubPid, pid)) {
+                e = eduom_UpdateAvailSpaceList(catObjForFile, &stubPid, stubPage, stubFreeSpace);
+                if (e < 0) ERRB2(e, &stubPid, PAGE_BUF, &pid, PAGE_BUF);
+            }
+
+            e = eduom_SetDirty(&stubPid, PAGE_BUF);
+            if (e < 0) ERRB2(e, &stubPid, PAGE_BUF, &pid, PAGE_BUF);
+
+            e = BfM_FreeTrain(&stubPid, PAGE_BUF);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+            modified = TRUE;
+            (*nCollapsed)++;
+        }
+
+        if (modified) {
+            e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+            e = eduom_SetDirty(&pid, PAGE_BUF);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+        }
+
+        *pageNo = apage->header.nextPage;
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* EduOM_CollapseForwarding() */
@@ -0,0 +1,486 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_Scan.c
+ * 
+ * Description : 
+ *  A sequential scan over the objects of a data file. Unlike calling
+ *  EduOM_NextObject() repeatedly, the scan cursor keeps the current page
+ *  fixed in the buffer, so each page is fixed only once during the scan.
+ *
+ *  A scan opened by EduOM_OpenSequentialScan() does not keep in the buffer
+ *  the pages it brought in: such a page is removed from the buffer when the
+ *  cursor leaves it, so that a scan of a large file does not replace the
+ *  pages used by other operations. The pages already in the buffer when
+ *  the scan reaches them are left there. A page is removed only while no
+ *  object is pinned and no other scan is open, since the page may
+ *  otherwise still be fixed by them.
+ *
+ * Exports:
+ *  Four EduOM_OpenScan(ObjectID*, ScanCursor*)
+ *  Four EduOM_OpenSequentialScan(ObjectID*, ScanCursor*)
+ *  Four EduOM_ScanNext(ScanCursor*, ObjectID*, ObjectHdr*)
+ *  Four EduOM_ScanPageBatch(ScanCursor*, ObjectID[], ObjectHdr[], const char*[], Four)
+ *  Four EduOM_CloseScan(ScanCursor*)
+ */
+
+
+#include "EduOM_common.h"
+#include "BfM.h"		/* for the buffer manager call */
+#include "EduOM_Internal.h"
+
+
+/* # of scans opened and not yet closed */
+static Four eduom_nOpenScans = 0;
+
+
+/* Macro: EDUOM_IN_BUFFER(pid)
+ * Description: check whether the page is in the buffer
+ */
+#define EDUOM_IN_BUFFER(pid)	((bfm_LookUp(pid, PAGE_BUF) >= 0) ? TRUE : FALSE)
+
+
+
+/*@================================
+ * eduom_ScanReleasePage()
+ *================================*/
+/*
+ * Function: Four eduom_ScanReleasePage(ScanCursor*)
+ *
+ * Description :
+ *  Free the current page of the scan. If the scan evicts the pages it
+ *  brought in and it brought in the current page, the page is written out
+ *  if dirty and removed from the buffer. If the removal fails, the page is
+ *  only freed and stays in the buffer.
+ *
+ *  The buffer manager does not expose fix counts, and BfM_RemoveTrain()
+ *  removes a page even if it is still fixed. The page is therefore removed
+ *  only while no object is pinned and no other scan is open. This covers
+ *  the fixes made through EduOM only: a page that another layer of the
+ *  storage system fixed after the scan brought it in is removed as well.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four eduom_ScanReleasePage(
+    ScanCursor	*cursor)	/* INOUT scan cursor */
+{
+    Four     	e;              /* error code */
+
+
+    if (cursor->evict && cursor->ownPage && eduom_nPins == 0 && eduom_nOpenScans == 1) {
+        /* the removal also drops the fix of the scan */
+        e = BfM_RemoveTrain(&(cursor->pid), PAGE_BUF, TRUE);
+        if (e < 0) e = BfM_FreeTrain(&(cursor->pid), PAGE_BUF);
+    }
+    else
+        e = BfM_FreeTrain(&(cursor->pid), PAGE_BUF);
+
+    cursor->pinned = FALSE;
+
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* eduom_ScanReleasePage() */
+
+
+
+/*@================================
+ * eduom_ScanNextPage()
+ *================================*/
+/*
+ * Function: Four eduom_ScanNextPage(ScanCursor*)
+ *
+ * Description :
+ *  Release the current page of the scan and fix the next page of the file.
+ *
+ * Returns:
+ *  error code
+ *    EOS
+ *    some errors caused by function calls
+ */
+static Four eduom_ScanNextPage(
+    ScanCursor	*cursor)	/* INOUT scan cursor */
+{
+    Four     	e;              /* error code */
+    PageNo	nextPage;	/* next page of the current page */
+
+
+    nextPage = cursor->apage->header.nextPage;
+
+    if (nextPage == NIL) return(EOS);
+
+    e = eduom_ScanReleasePage(cursor);
+    if (e < 0) ERR(e);
+
+    MAKE_PAGEID(cursor->pid, cursor->pid.volNo, nextPage);
+
+    cursor->ownPage = (cursor->evict && !EDUOM_IN_BUFFER(&(cursor->pid))) ? TRUE : FALSE;
+
+    e = BfM_GetTrain(&(cursor->pid), (char **)&(cursor->apage), PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    cursor->slotNo = NIL;
+    cursor->pinned = TRUE;
+
+    return(eNOERROR);
+
+} /* eduom_ScanNextPage() */
+
+
+
+/*@================================
+ * eduom_OpenScan()
+ *================================*/
+/*
+ * Function: Four eduom_OpenScan(ObjectID*, Boolean, ScanCursor*)
+ * 
+ * Description : 
+ *  Open a scan on the data file and fix its first page.
+ *
+ * Returns:
+ *  error code
+ *    eBADCATALOGOBJECT_OM
+ *    eBADPARAMETER_OM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter cursor
+ *     'cursor' is positioned before the first object of the file
+ */
+static Four eduom_OpenScan(
+    ObjectID	*catObjForFile,	/* IN file to scan */
+    Boolean	evict,		/* IN TRUE if the pages brought in are evicted first */
+    ScanCursor	*cursor)	/* OUT scan cursor */
+{
+    Four     	e;              /* error code */
+    sm_CatOverlayForData *catEntry; /* cached catalog information of the file */
+
+
+    /*@ check parameters */
+
+    if (catObjForFile == NULL) ERR(eBADCATALOGOBJECT_OM);
+
+    if (cursor == NULL) ERR(eBADPARAMETER_OM);
+
+    cursor->open = cursor->pinned = FALSE;
+
+    e = eduom_GetCatalogEntry(catObjForFile, &catEntry);
+    if (e < 0) ERR(e);
+
+    MAKE_PAGEID(cursor->pid, catEntry->fid.volNo, catEntry->firstPage);
+
+    cursor->evict = evict;
+    cursor->ownPage = (evict && !EDUOM_IN_BUFFER(&(cursor->pid))) ? TRUE : FALSE;
+
+    e = BfM_GetTrain(&(cursor->pid), (char **)&(cursor->apage), PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    cursor->slotNo = NIL;
+    cursor->pinned = TRUE;
+    cursor->open = TRUE;
+
+    eduom_nOpenScans++;
+
+    return(eNOERROR);
+    
+} /* eduom_OpenScan() */
+
+
+
+/*@================================
+ * EduOM_OpenScan()
+ *================================*/
+/*
+ * Function: Four EduOM_OpenScan(ObjectID*, ScanCursor*)
+ * 
+ * Description : 
+ *  Open a scan on the data file and fix its first page.
+ *
+ * Returns:
+ *  error code
+ *    eBADCATALOGOBJECT_OM
+ *    eBADPARAMETER_OM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter cursor
+ *     'cursor' is positioned before the first object of the file
+ */
+Four EduOM_OpenScan(
+    ObjectID	*catObjForFile,	/* IN file to scan */
+    ScanCursor	*cursor)	/* OUT scan cursor */
+{
+    Four     	e;              /* error code */
+
+
+    e = eduom_OpenScan(catObjForFile, FALSE, cursor);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+    
+} /* EduOM_OpenScan() */
+
+
+
+/*@================================
+ * EduOM_OpenSequentialScan()
+ *================================*/
+/*
+ * Function: Four EduOM_OpenSequentialScan(ObjectID*, ScanCursor*)
+ * 
+ * Description : 
+ *  Open a scan on the data file like EduOM_OpenScan(), but the pages the
+ *  scan brings into the buffer are removed from the buffer when the cursor
+ *  leaves them. Use it for a scan of a file too large to be kept in the
+ *  buffer.
+ *
+ * Returns:
+ *  error code
+ *    eBADCATALOGOBJECT_OM
+ *    eBADPARAMETER_OM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter cursor
+ *     'cursor' is positioned before the first object of the file
+ */
+Four EduOM_OpenSequentialScan(
+    ObjectID	*catObjForFile,	/* IN file to scan */
+    ScanCursor	*cursor)	/* OUT scan cursor */
+{
+    Four     	e;              /* error code */
+
+
+    e = eduom_OpenScan(catObjForFile, TRUE, cursor);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+    
+} /* EduOM_OpenSequentialScan() */
+
+
+
+/*@================================
+ * EduOM_ScanNext()
+ *================================*/
+/*
+ * Function: Four EduOM_ScanNext(ScanCursor*, ObjectID*, ObjectHdr*)
+ * 
+ * Description : 
+ *  (1) What to do?
+ *  EduOM_ScanNext() returns the next object of the scan. Empty slots and
+ *  forwarding stubs are skipped, and the scan moves to the next page when
+ *  the current page is exhausted. A forwarded record is returned with the
+ *  ObjectID of its stub, so each object is returned once.
+ *
+ *  (2) How to do?
+ *  a. Find the next slot holding an object in the current page
+ *  b. If there is none, release the current page and fix the next page
+ *     repeating from a.
+ *  c. Return EOS at the end of the last page
+ *
+ * Returns:
+ *  error code
+ *    EOS
+ *    eBADPARAMETER_OM
+ *    eBADOBJECTID_OM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter oid
+ *     'oid' is filled with the next object's identifier
+ *  2) parameter objHdr
+ *     'objHdr' is filled with the next object's header if it is not NULL
+ */
+Four EduOM_ScanNext(
+    ScanCursor	*cursor,	/* INOUT scan cursor */
+    ObjectID	*oid,		/* OUT the next object */
+    ObjectHdr	*objHdr)	/* OUT the header of the next object */
+{
+    Four     	e;              /* error code */
+    Two		i;		/* slot index */
+    SlottedPage	*apage;		/* pointer to the buffer of the current page */
+    Object	*obj;		/* pointer to the object in the slotted page */
+
+
+    /*@ check parameters */
+
+    if (cursor == NULL || !cursor->pinned) ERR(eBADPARAMETER_OM);
+
+    if (oid == NULL) ERR(eBADOBJECTID_OM);
+
+    for ( ; ; ) {
+
+        apage = cursor->apage;
+
+        for (i = cursor->slotNo + 1; i < apage->header.nSlots; i++) {
+            if (apage->slot[-i].offset == EMPTYSLOT) continue;
+
+            obj = (Object *)&(apage->data[apage->slot[-i].offset]);
+            if (obj->header.properties & P_MOVED) continue;
+
+            eduom_GetLogicalObject(apage, i, oid, objHdr);
+
+            cursor->slotNo = i;
+
+            return(eNOERROR);
+        }
+
+        /* the current page is exhausted */
+        cursor->slotNo = apage->header.nSlots - 1;
+
+        e = eduom_ScanNextPage(cursor);
+        if (e < 0) ERR(e);
+
+        if (e == EOS) return(EOS);
+    }
+    
+} /* EduOM_ScanNext() */
+
+
+/*@================================
+ * EduOM_ScanPageBatch()
+ *================================*/
+/*
+ * Function: Four EduOM_ScanPageBatch(ScanCursor*, ObjectID[], ObjectHdr[], const char*[], Four)
+ * 
+ * Description : 
+ *  (1) What to do?
+ *  EduOM_ScanPageBatch() returns at most 'max' objects of the scan at once.
+ *  The objects are taken from one page: the batch ends at the end of the
+ *  current page, and the next call continues from the next page. The
+ *  pointers in 'ptrs' point to the data of the objects in the buffer and
+ *  are valid until the next call on the cursor. The pointer of a large
+ *  object is NULL since its data are not in the page; read it with
+ *  EduOM_ReadObject().
+ *
+ *  (2) How to do?
+ *  a. Collect the objects of the current page after the cursor
+ *  b. If there is none, fix the next page and repeat from a.
+ *
+ * Returns:
+ *  # of objects returned, 0 at the end of the scan
+ *  error code
+ *    eBADPARAMETER_OM
+ *    eBADUSERBUF_OM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter oids, hdrs, ptrs
+ *     The first n entries are filled with the identifiers, the headers, and
+ *     the pointers to the data of the objects. 'hdrs' and 'ptrs' may be NULL.
+ */
+Four EduOM_ScanPageBatch(
+    ScanCursor	*cursor,	/* INOUT scan cursor */
+    ObjectID	oids[],		/* OUT identifiers of the objects */
+    ObjectHdr	hdrs[],		/* OUT headers of the objects */
+    const char	*ptrs[],	/* OUT pointers to the data of the objects */
+    Four	max)		/* IN maximum # of objects to return */
+{
+    Four     	e;              /* error code */
+    Four	n;		/* # of objects returned */
+    Two		i;		/* slot index */
+    Two		nSlots;		/* # of slots of the current page */
+    SlottedPage	*apage;		/* pointer to the buffer of the current page */
+    Object	*obj;		/* pointer to the object in the slotted page */
+
+
+    /*@ check parameters */
+
+    if (cursor == NULL || !cursor->pinned || max <= 0) ERR(eBADPARAMETER_OM);
+
+    if (oids == NULL) ERR(eBADUSERBUF_OM);
+
+    for ( ; ; ) {
+
+        apage = cursor->apage;
+        nSlots = apage->header.nSlots;
+
+        for (n = 0, i = cursor->slotNo + 1; i < nSlots && n < max; i++) {
+            if (apage->slot[-i].offset == EMPTYSLOT) continue;
+
+            obj = (Object *)&(apage->data[apage->slot[-i].offset]);
+            if (obj->header.properties & P_MOVED) continue;
+
+            eduom_GetLogicalObject(apage, i, &oids[n], (hdrs != NULL) ? &hdrs[n] : NULL);
+            if (ptrs != NULL)
+                ptrs[n] = (obj->header.properties & P_LRGOBJ) ? NULL : OBJ_DATA(obj);
+
+            n++;
+        }
+
+        cursor->slotNo = i - 1;
+
+        if (n > 0) return(n);
+
+        e = eduom_ScanNextPage(cursor);
+        if (e < 0) ERR(e);
+
+        if (e == EOS) return(0);
+    }
+    
+} /* EduOM_ScanPageBatch() */
+
+
+
+/*@================================
+ * EduOM_CloseScan()
+ *================================*/
+/*
+ * Function: Four EduOM_CloseScan(ScanCursor*)
+ * 
+ * Description : 
+ *  Close the scan releasing the page fixed by the cursor. The scan is
+ *  closed even if it lost its page because fixing the next page failed.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_OM
+ *    some errors caused by function calls
+ */
+Four EduOM_CloseScan(
+    ScanCursor	*cursor)	/* INOUT scan cursor */
+{
+    Four     	e;              /* error code */
+
+
+    if (cursor == NULL) ERR(eBADPARAMETER_OM);
+
+    if (!cursor->open) return(eNOERROR);
+
+    e = eNOERROR;
+    if (cursor->pinned) e = eduom_ScanReleasePage(cursor);
+
+    cursor->open = FALSE;
+    eduom_nOpenScans--;
+
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+    
+} /* EduOM_CloseScan() */
@@ -0,0 +1,158 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_Statistics.c
+ * 
+ * Description :
+ *  Keep the counters of the EduOM operations so that the behavior of the
+ *  object manager can be checked on a running system.
+ *
+ * Exports:
+ *  Four EduOM_GetStatistics(EduOM_Statistics*)
+ *  Four EduOM_ResetStatistics(void)
+ *  Four EduOM_GetClustering(ObjectID[], Four, EduOM_Clustering*)
+ */
+
+#include <string.h>
+#include "EduOM_common.h"
+#include "RDsM.h"		/* for the raw disk manager call */
+#include "EduOM_Internal.h"
+
+
+/* counters of the EduOM operations */
+EduOM_Statistics eduom_stat;
+
+
+
+/*@================================
+ * EduOM_GetStatistics()
+ *================================*/
+/*
+ * Function: Four EduOM_GetStatistics(EduOM_Statistics*)
+ *
+ * Description :
+ *  Return the counters accumulated since the last EduOM_ResetStatistics()
+ *  and the current # of dirty pages queued for write behind.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_OM
+ *    eNOERROR
+ */
+Four EduOM_GetStatistics(
+    EduOM_Statistics	*stat)		/* OUT counters of the EduOM operations */
+{
+    if (stat == NULL) ERR(eBADPARAMETER_OM);
+
+    *stat = eduom_stat;
+    stat->nDirtyQueued = eduom_nDirtyQueued;
+
+    return(eNOERROR);
+
+} /* EduOM_GetStatistics() */
+
+
+
+/*@================================
+ * EduOM_ResetStatistics()
+ *================================*/
+/*
+ * Function: Four EduOM_ResetStatistics(void)
+ *
+ * Description :
+ *  Clear all the counters.
+ *
+ * Returns:
+ *  error code
+ *    eNOERROR
+ */
+Four EduOM_ResetStatistics(void)
+{
+    memset(&eduom_stat, 0, sizeof(EduOM_Statistics));
+
+    return(eNOERROR);
+
+} /* EduOM_ResetStatistics() */
+
+
+
+/*@================================
+ * EduOM_GetClustering()
+ *================================*/
+/*
+ * Function: Four EduOM_GetClustering(ObjectID[], Four, EduOM_Clustering*)
+ *
+ * Description :
+ *  Measure the clustering of the objects 'oids' which are logically
+ *  adjacent in the given order, e.g. the objects in the order of loading.
+ *  For each pair of adjacent objects, the distance between the extents
+ *  holding them is counted; the average distance is
+ *  sumExtDistance / nPairs and is 0 for a perfectly clustered sequence.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_OM
+ *    some errors caused by function calls
+ */
+Four EduOM_GetClustering(
+    ObjectID		oids[],		/* IN objects in the logical order */
+    Four		nOids,		/* IN # of objects in 'oids' */
+    EduOM_Clustering	*clu)		/* OUT clustering of the objects */
+{
+    Four		e;		/* error number */
+    Four		i;		/* index of an object */
+    Four		extNo;		/* extent holding the current object */
+    Four		prevExtNo;	/* extent holding the previous object */
+    Four		dist;		/* extent distance of a pair */
+    PageID		pid;		/* page holding the current object */
+
+
+    /*@ check parameters */
+    if (oids == NULL || nOids < 0 || clu == NULL) ERR(eBADPARAMETER_OM);
+
+    memset(clu, 0, sizeof(EduOM_Clustering));
+
+    prevExtNo = NIL;
+    for (i = 0; i < nOids; i++) {
+        MAKE_PAGEID(pid, oids[i].volNo, oids[i].pageNo);
+        e = RDsM_PageIdToExtNo(&pid, &extNo);
+        if (e < 0) ERR(e);
+
+        if (i > 0) {
+            dist = (extNo > prevExtNo) ? extNo - prevExtNo : prevExtNo - extNo;
+
+            clu->nPairs++;
+            if (oids[i].volNo == oids[i-1].volNo && oids[i].pageNo == oids[i-1].pageNo) clu->nSamePage++;
+            if (dist == 0) clu->nSameExtent++;
+            clu->sumExtDistance += dist;
+            if (dist > clu->maxExtDistance) clu->maxExtDistance = dist;
+        }
+
+        prevExtNo = extNo;
+    }
+
+    return(eNOERROR);
+
+} /* EduOM_GetClustering() */
@@ -36,6 +36,12 @@
 #include "EduOM_TestModule.h"
 
 
+/* volume formatted for the test; 'make check' builds with its own */
+#ifndef EDUOM_TEST_VOLUME
+#define EDUOM_TEST_VOLUME	"test.vol"
+#endif
+
+
 Four main(int argc, char *argv[]) 
 {
 
@@ -74,7 +80,7 @@ Four main(int argc, char *argv[])
 
 	/* Initialize the variable for LRDS_FormatDataVolume */
 	numDevices = 1;
-	devNames[0] = "test.vol";
+	devNames[0] = EDUOM_TEST_VOLUME;
 	title = "test";
 	volId = 1000;
 	extSize = 16;
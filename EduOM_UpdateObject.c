@@ -0,0 +1,289 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_UpdateObject.c
+ * 
+ * Description : 
+ *  EduOM_UpdateObject() replaces the data of an object keeping its
+ *  ObjectID. An object which no longer fits in its page is moved to
+ *  another page and leaves a forwarding stub behind.
+ *
+ * Exports:
+ *  Four EduOM_UpdateObject(ObjectID*, ObjectID*, Four, char*)
+ */
+
+
+#include <string.h>
+#include "EduOM_common.h"
+#include "BfM.h"		/* for the buffer manager call */
+#include "EduOM_Internal.h"
+
+
+
+/*@================================
+ * eduom_FindRecordToMove()
+ *================================*/
+/*
+ * Function: static Two eduom_FindRecordToMove(SlottedPage*, Two, Four, Four*)
+ *
+ * Description :
+ *  An object shorter than an ObjectID needs more room when it is turned
+ *  into a stub. Find another record in the page whose move to another page
+ *  frees at least 'shortage' bytes, taking the one needing the least space
+ *  in the destination page.
+ *
+ * Returns:
+ *  slot number of the record, or NIL if there is none
+ *
+ * Side Effects :
+ *  1) parameter neededSpace
+ *     'neededSpace' is set to the space the record needs in another page
+ */
+static Two eduom_FindRecordToMove(
+    SlottedPage	*apage,		/* IN page holding the object */
+    Two		slotNo,		/* IN slot of the object being updated */
+    Four	shortage,	/* IN # of bytes to free */
+    Four	*neededSpace)	/* OUT space needed by the record found */
+{
+    Two         i;		/* slot index */
+    Two         found;		/* record found */
+    Object      *obj;		/* a record in the page */
+    Four        gain;		/* # of bytes freed by moving the record */
+    Four        needed;		/* space needed by the record in another page */
+
+
+    found = NIL;
+
+    for (i = 0; i < apage->header.nSlots; i++) {
+        if (i == slotNo || apage->slot[-i].offset == EMPTYSLOT) continue;
+
+        obj = (Object *)&(apage->data[apage->slot[-i].offset]);
+        if (obj->header.properties & (P_MOVED | P_LRGOBJ)) continue;
+
+        if (obj->header.properties & P_FORWARDED) {
+            gain = sizeof(ObjectHdr) + ALIGNED_LENGTH(obj->header.length);
+            needed = sizeof(ObjectHdr) + ALIGNED_LENGTH(obj->header.length) + sizeof(SlottedPageSlot);
+        } else {
+            gain = ALIGNED_LENGTH(obj->header.length) - ALIGNED_LENGTH(FWD_BACKPTR_LEN);
+            needed = sizeof(ObjectHdr) + ALIGNED_LENGTH(obj->header.length + FWD_BACKPTR_LEN) + sizeof(SlottedPageSlot);
+        }
+
+        if (gain >= shortage && (found == NIL || needed < *neededSpace)) {
+            found = i;
+            *neededSpace = needed;
+        }
+    }
+
+    return(found);
+
+} /* eduom_FindRecordToMove() */
+
+
+
+/*@================================
+ * EduOM_UpdateObject()
+ *================================*/
+/*
+ * Function: Four EduOM_UpdateObject(ObjectID*, ObjectID*, Four, char*)
+ * 
+ * Description : 
+ *  (1) What to do?
+ *  EduOM_UpdateObject() replaces the data of the object 'oid' with the
+ *  'length' bytes of 'data'. The ObjectID of the object does not change,
+ *  so references to the object, e.g. index entries, stay valid.
+ *
+ *  (2) How to do?
+ *  a. Fix the page holding the record of the object following its stub
+ *  b. IF the new data fit in the page THEN
+ *         resize the record in place and copy the data
+ *     ELSE
+ *         put a forwarded record with the new data into the best fit
+ *         page of the file, as for an object created without 'nearObj'
+ *         (an object too short to hold a stub takes another record of the
+ *          page along to make room for the stub)
+ *         IF the record was a forwarded record THEN
+ *             let the stub point to the new record and remove the old one
+ *         ELSE
+ *             turn the record into a stub
+ *         ENDIF
+ *     ENDIF
+ *  c. Move the pages in the available space lists
+ *
+ *  A moved object is always one hop away from its stub. Large objects are
+ *  not updated; they grow with EduOM_AppendToObject().
+ *
+ * Returns:
+ *  error code
+ *    eBADCATALOGOBJECT_OM
+ *    eBADOBJECTID_OM
+ *    eBADLENGTH_OM
+ *    eBADUSERBUF_OM
+ *    eNOTSUPPORTED_EDUOM
+ *    eNOSPACEFORSTUB_EDUOM
+ *    some errors caused by function calls
+ */
+Four EduOM_UpdateObject(
+    ObjectID	*catObjForFile,	/* IN file containing the object */
+    ObjectID	*oid,		/* IN object to update */
+    Four	length,		/* IN amount of new data */
+    char	*data)		/* IN the new data of the object */
+{
+    Four        e;		/* error number */
+    PageID      pid;		/* page holding the record of the object */
+    SlottedPage *apage;		/* buffer holding the page */
+    Object      *obj;		/* record of the object */
+    ObjectID    loc;		/* ObjectID of the record */
+    Four        recLen;		/* new length of the record */
+    Four        freeSpace;	/* free space of the page before */
+    PageID      dstPid;		/* page into which the object is moved */
+    SlottedPage *dstPage;	/* buffer holding the page */
+    Four        dstFreeSpace;	/* free space of the page before */
+    ObjectHdr   objHdr;		/* header of the forwarded record */
+    ObjectID    stubOid;	/* the stub of the object */
+    ObjectID    newOid;		/* the new forwarded record */
+    Boolean     forwarded;	/* TRUE if the record is a forwarded record */
+    Four        neededSpace;	/* space needed by the object in another page */
+    Four        shortage;	/* room missing to turn the object into a stub */
+    Two         moveSlot;	/* another record moved to make room */
+    Four        moveNeeded;	/* space needed by that record */
+    char        buf[PAGESIZE];	/* the new record with its back pointer */
+
+
+    /*@ check parameters */
+    if (catObjForFile == NULL) ERR(eBADCATALOGOBJECT_OM);
+
+    if (oid == NULL) ERR(eBADOBJECTID_OM);
+
+    if (length < 0) ERR(eBADLENGTH_OM);
+
+    if (data == NULL && length > 0) ERR(eBADUSERBUF_OM);
+
+    if (ALIGNED_LENGTH(length) > LRGOBJ_THRESHOLD) ERR(eNOTSUPPORTED_EDUOM);
+
+    e = eduom_FixObject(oid, &pid, &apage, &obj, &loc);
+    if (e < 0) ERR(e);
+
+    if (obj->header.properties & P_LRGOBJ) ERRB1(eNOTSUPPORTED_EDUOM, &pid, PAGE_BUF);
+
+    forwarded = (obj->header.properties & P_FORWARDED) ? TRUE : FALSE;
+    recLen = length + (forwarded ? FWD_BACKPTR_LEN : 0);
+    freeSpace = SP_FREE(apage);
+
+    /*@ update in place */
+    if (ALIGNED_LENGTH(recLen) - ALIGNED_LENGTH(obj->header.length) <= freeSpace) {
+        e = eduom_ResizeInPage(apage, loc.slotNo, recLen);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        obj = (Object *)&(apage->data[apage->slot[-(loc.slotNo)].offset]);
+        if (length > 0) memcpy(OBJ_DATA(obj), data, length);
+
+        e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = eduom_SetDirty(&pid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    /*@ move the object to another page */
+    if (ALIGNED_LENGTH(length + FWD_BACKPTR_LEN) > LRGOBJ_THRESHOLD)
+        ERRB1(eNOTSUPPORTED_EDUOM, &pid, PAGE_BUF);
+
+    neededSpace = sizeof(ObjectHdr) + ALIGNED_LENGTH(length + FWD_BACKPTR_LEN) + sizeof(SlottedPageSlot);
+
+    /* a short object needs more room to become a stub; move another record too */
+    moveSlot = NIL;
+    shortage = forwarded ? 0 : ALIGNED_LENGTH(FWD_BACKPTR_LEN) - ALIGNED_LENGTH(obj->header.length) - freeSpace;
+    if (shortage > 0) {
+        moveSlot = eduom_FindRecordToMove(apage, loc.slotNo, shortage, &moveNeeded);
+        if (moveSlot == NIL) ERRB1(eNOSPACEFORSTUB_EDUOM, &pid, PAGE_BUF);
+    }
+
+    if (forwarded)
+        memcpy(&stubOid, obj->data, sizeof(ObjectID));
+    else
+        stubOid = loc;
+
+    objHdr = obj->header;
+    objHdr.properties |= P_FORWARDED;
+
+    memcpy(buf, &stubOid, sizeof(ObjectID));
+    if (length > 0) memcpy(&buf[FWD_BACKPTR_LEN], data, length);
+
+    e = eduom_GetPageForInsert(catObjForFile, NULL, neededSpace + ((moveSlot != NIL) ? moveNeeded : 0),
+                               &dstPid, &dstPage);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    dstFreeSpace = SP_FREE(dstPage);
+
+    if (moveSlot != NIL) {
+        e = eduom_RelocateObject(&pid, apage, moveSlot, dstPage, &newOid);
+        if (e < 0) ERRB2(e, &pid, PAGE_BUF, &dstPid, PAGE_BUF);
+    }
+
+    e = eduom_InsertInPage(dstPage, &objHdr, length + FWD_BACKPTR_LEN, buf, &newOid);
+    if (e < 0) ERRB2(e, &pid, PAGE_BUF, &dstPid, PAGE_BUF);
+
+    e = eduom_UpdateAvailSpaceList(catObjForFile, &dstPid, dstPage, dstFreeSpace);
+    if (e < 0) ERRB2(e, &pid, PAGE_BUF, &dstPid, PAGE_BUF);
+
+    e = eduom_SetDirty(&dstPid, PAGE_BUF);
+    if (e < 0) ERRB2(e, &pid, PAGE_BUF, &dstPid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&dstPid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    if (forwarded) {
+        /* the stub points to the new record directly */
+        e = eduom_RetargetStub(&stubOid, &newOid);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = eduom_RemoveFromPage(apage, loc.slotNo);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+    } else {
+        e = eduom_ResizeInPage(apage, loc.slotNo, FWD_BACKPTR_LEN);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        obj = (Object *)&(apage->data[apage->slot[-(loc.slotNo)].offset]);
+        obj->header.properties |= P_MOVED;
+        memcpy(obj->data, &newOid, sizeof(ObjectID));
+    }
+
+    e = eduom_UpdateAvailSpaceList(catObjForFile, &pid, apage, freeSpace);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = eduom_SetDirty(&pid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+    
+} /* EduOM_UpdateObject() */
@@ -0,0 +1,316 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module : EduOM_WriteBehind.c
+ * 
+ * Description :
+ *  Write behind of the pages set dirty by EduOM. The pages are queued when
+ *  they are set dirty, and EduOM_FlushDirtyPages() writes them out in the
+ *  order of their page numbers when the application has time, e.g. between
+ *  transactions. The pages written stay in the buffer but are clean, so
+ *  the buffer manager can replace them later without writing them on the
+ *  path of an insert.
+ *
+ *  A page is queued once until it is written. When the queue is full, the
+ *  pages the buffer manager has already replaced, and so written, are
+ *  removed from it; a page set dirty while the queue is still full is not
+ *  queued and is written when it is replaced, as before.
+ *
+ * Exports:
+ *  Four EduOM_FlushDirtyPages(Four, Four*)
+ *
+ * Internal Exports:
+ *  Four eduom_SetDirty(PageID*, Four)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduOM_common.h"
+#include "BfM.h"		/* for the buffer manager call */
+#include "EduOM_Internal.h"
+
+
+/* number of dirty pages queued at most */
+#define EDUOM_WB_QUEUESIZE	1024
+
+/* number of hash slots of the queue, a power of 2 larger than the queue */
+#define EDUOM_WB_HASHSIZE	2048
+
+/* Macro: EDUOM_WB_HASH(pid)
+ * Description: return the first hash slot of the page
+ */
+#define EDUOM_WB_HASH(pid) \
+	((UFour)((pid)->pageNo * 31 + (pid)->volNo) & (EDUOM_WB_HASHSIZE - 1))
+
+/* dirty pages waiting to be written */
+static PageID eduom_wbQueue[EDUOM_WB_QUEUESIZE];
+
+/* # of pages in the queue */
+Four eduom_nDirtyQueued = 0;
+
+/* index + 1 of the queue entry of a page, 0 if the slot is empty */
+static Four eduom_wbHash[EDUOM_WB_HASHSIZE];
+
+/* number of pages set dirty while the queue was full; the full queue is
+ * pruned once every EDUOM_WB_QUEUESIZE/4 such pages so that the cost of
+ * pruning is spread over them */
+static Four eduom_wbNotQueued = 0;
+
+
+
+/*@================================
+ * eduom_WbLookUp()
+ *================================*/
+/*
+ * Function: Four *eduom_WbLookUp(PageID*)
+ *
+ * Description :
+ *  Find the hash slot of the page, probing linearly from its first slot.
+ *
+ * Returns:
+ *  pointer to the slot holding the page, or to the empty slot where the
+ *  page would be put
+ */
+static Four *eduom_WbLookUp(
+    PageID	*pid)		/* IN page to find */
+{
+    UFour	h;		/* hash slot */
+
+
+    for (h = EDUOM_WB_HASH(pid); eduom_wbHash[h] != 0; h = (h + 1) & (EDUOM_WB_HASHSIZE - 1))
+        if (EQUAL_PAGEID(eduom_wbQueue[eduom_wbHash[h] - 1], *pid)) break;
+
+    return(&eduom_wbHash[h]);
+
+} /* eduom_WbLookUp() */
+
+
+
+/*@================================
+ * eduom_WbRebuildHash()
+ *================================*/
+/*
+ * Function: void eduom_WbRebuildHash(void)
+ *
+ * Description :
+ *  Rebuild the hash of the queue after entries are removed from the queue.
+ *
+ * Returns:
+ *  None
+ */
+static void eduom_WbRebuildHash(void)
+{
+    Four	i;		/* index variable */
+
+
+    memset(eduom_wbHash, 0, sizeof(eduom_wbHash));
+
+    for (i = 0; i < eduom_nDirtyQueued; i++)
+        *eduom_WbLookUp(&eduom_wbQueue[i]) = i + 1;
+
+} /* eduom_WbRebuildHash() */
+
+
+
+/*@================================
+ * eduom_WbPrune()
+ *================================*/
+/*
+ * Function: void eduom_WbPrune(void)
+ *
+ * Description :
+ *  Remove from the queue the pages no longer in the buffer.
+ *
+ * Returns:
+ *  None
+ */
+static void eduom_WbPrune(void)
+{
+    Four	i, j;		/* index variables */
+
+
+    for (i = j = 0; i < eduom_nDirtyQueued; i++)
+        if (bfm_LookUp(&eduom_wbQueue[i], PAGE_BUF) >= 0)
+            eduom_wbQueue[j++] = eduom_wbQueue[i];
+
+    eduom_nDirtyQueued = j;
+
+    eduom_WbRebuildHash();
+
+} /* eduom_WbPrune() */
+
+
+
+/*@================================
+ * eduom_WbComparePageId()
+ *================================*/
+/*
+ * Function: int eduom_WbComparePageId(const void*, const void*)
+ *
+ * Description :
+ *  Compare two pages by the volume number and the page number, for qsort().
+ *
+ * Returns:
+ *  negative, zero or positive as the first page precedes, equals or
+ *  follows the second
+ */
+static int eduom_WbComparePageId(
+    const void	*a,		/* IN first page */
+    const void	*b)		/* IN second page */
+{
+    const PageID *x = (const PageID *)a;
+    const PageID *y = (const PageID *)b;
+
+
+    if (x->volNo != y->volNo) return((x->volNo < y->volNo) ? -1 : 1);
+    if (x->pageNo != y->pageNo) return((x->pageNo < y->pageNo) ? -1 : 1);
+
+    return(0);
+
+} /* eduom_WbComparePageId() */
+
+
+
+/*@================================
+ * eduom_SetDirty()
+ *================================*/
+/*
+ * Function: Four eduom_SetDirty(PageID*, Four)
+ *
+ * Description :
+ *  Set the page dirty in the buffer and queue it for EduOM_FlushDirtyPages()
+ *  unless it is already queued or the queue is full even after pruning.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four eduom_SetDirty(
+    PageID	*pid,		/* IN page set dirty */
+    Four	type)		/* IN buffer type */
+{
+    Four	e;		/* error number */
+    Four	*slot;		/* hash slot of the page */
+
+
+    e = BfM_SetDirty(pid, type);
+    if (e < 0) ERR(e);
+
+    if (type != PAGE_BUF) return(eNOERROR);
+
+    slot = eduom_WbLookUp(pid);
+    if (*slot != 0) return(eNOERROR);
+
+    if (eduom_nDirtyQueued == EDUOM_WB_QUEUESIZE) {
+        if (eduom_wbNotQueued++ % (EDUOM_WB_QUEUESIZE / 4) != 0) return(eNOERROR);
+
+        eduom_WbPrune();
+        if (eduom_nDirtyQueued == EDUOM_WB_QUEUESIZE) return(eNOERROR);
+
+        slot = eduom_WbLookUp(pid);
+    }
+
+    eduom_wbQueue[eduom_nDirtyQueued++] = *pid;
+    *slot = eduom_nDirtyQueued;
+
+    return(eNOERROR);
+
+} /* eduom_SetDirty() */
+
+
+
+/*@================================
+ * EduOM_FlushDirtyPages()
+ *================================*/
+/*
+ * Function: Four EduOM_FlushDirtyPages(Four, Four*)
+ *
+ * Description :
+ *  (1) What to do?
+ *  EduOM_FlushDirtyPages() writes out at most 'maxPages' of the dirty pages
+ *  queued by EduOM, in the order of their page numbers so that adjacent
+ *  pages are written one after another. The pages stay in the buffer.
+ *  Pages no longer in the buffer have been written when they were replaced
+ *  and are only removed from the queue.
+ *
+ *  (2) How to do?
+ *  a. Sort the queue by the page number
+ *  b. Write out the first 'maxPages' pages still in the buffer
+ *  c. Remove them from the queue and rebuild the hash of the rest, also
+ *     when writing a page fails
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_OM
+ *    some errors caused by function calls
+ *
+ * Side Effects :
+ *  1) parameter nFlushed
+ *     'nFlushed' is set to the # of pages written if it is not NULL
+ */
+Four EduOM_FlushDirtyPages(
+    Four	maxPages,	/* IN maximum # of pages to write */
+    Four	*nFlushed)	/* OUT # of pages written */
+{
+    Four	e;		/* error number */
+    Four	i;		/* index variable */
+    Four	n;		/* # of pages taken from the queue */
+    Four	flushed;	/* # of pages written */
+
+
+    if (maxPages < 0) ERR(eBADPARAMETER_OM);
+
+    n = (maxPages < eduom_nDirtyQueued) ? maxPages : eduom_nDirtyQueued;
+
+    qsort(eduom_wbQueue, eduom_nDirtyQueued, sizeof(PageID), eduom_WbComparePageId);
+
+    for (e = eNOERROR, flushed = 0, i = 0; i < n; i++) {
+        if (bfm_LookUp(&eduom_wbQueue[i], PAGE_BUF) < 0) continue;
+
+        e = bfm_FlushTrain(&eduom_wbQueue[i], PAGE_BUF);
+        if (e < 0) break;
+
+        flushed++;
+    }
+
+    /* on an error, the pages before the failed one are written; the
+     * failed one and the rest stay queued */
+    if (i < n) n = i;
+
+    /*@ remove the pages taken from the queue; the sort moved the others */
+    eduom_nDirtyQueued -= n;
+    memmove(eduom_wbQueue, &eduom_wbQueue[n], eduom_nDirtyQueued * sizeof(PageID));
+
+    eduom_WbRebuildHash();
+
+    eduom_stat.nPagesFlushed += flushed;
+
+    if (nFlushed != NULL) *nFlushed = flushed;
+
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* EduOM_FlushDirtyPages() */
@@ -38,6 +38,7 @@ Four BfM_FreeTrain(TrainID *, Four);
 Four BfM_GetTrain(TrainID *, char **, Four);
 Four BfM_GetNewTrain(TrainID *, char **, Four);
 Four BfM_SetDirty(TrainID *, Four);
+Four BfM_RemoveTrain(TrainID *, Four, Boolean);
 
 
 #endif /* _BFM_H_ */
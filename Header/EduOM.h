@@ -36,11 +36,32 @@
  */
 /* Interface Function Prototypes */
 Four EduOM_CompactPage(SlottedPage*, Two);
-Four EduOM_CreateObject(ObjectID*, ObjectID*, ObjectHdr*, Four, void*, ObjectID*);
+Four EduOM_CreateObject(ObjectID*, ObjectID*, ObjectHdr*, Four, char*, ObjectID*);
+Four EduOM_CreateObjects(ObjectID*, ObjectID*, Four, ObjectHdr*, Four*, char**, ObjectID*);
 Four EduOM_DestroyObject(ObjectID*, ObjectID*, Pool*, DeallocListElem*);
 Four EduOM_NextObject(ObjectID*, ObjectID*, ObjectID*, ObjectHdr*);
 Four EduOM_PrevObject(ObjectID*, ObjectID*, ObjectID*, ObjectHdr*);
+Four EduOM_UpdateObject(ObjectID*, ObjectID*, Four, char*);
+Four EduOM_AppendToObject(ObjectID*, ObjectID*, Four, char*, Pool*, DeallocListElem*);
 Four EduOM_ReadObject(ObjectID*, Four, Four, void*);
+Four EduOM_PinObject(ObjectID*, const void**, Four*, PinHandle*);
+Four EduOM_UnpinObject(PinHandle*);
+Four EduOM_CheckPinLeaks(void);
+Four EduOM_OpenScan(ObjectID*, ScanCursor*);
+Four EduOM_OpenSequentialScan(ObjectID*, ScanCursor*);
+Four EduOM_ScanNext(ScanCursor*, ObjectID*, ObjectHdr*);
+Four EduOM_ScanPageBatch(ScanCursor*, ObjectID[], ObjectHdr[], const char*[], Four);
+Four EduOM_CloseScan(ScanCursor*);
+Four EduOM_InitBulkLoad(ObjectID*, Four, BulkLoadHandle*);
+Four EduOM_NextBulkLoad(BulkLoadHandle*, ObjectHdr*, Four, char*, ObjectID*);
+Four EduOM_FinalBulkLoad(BulkLoadHandle*);
+Four EduOM_InvalidateCatalogCache(ObjectID*);
+Four EduOM_GetStatistics(EduOM_Statistics*);
+Four EduOM_ResetStatistics(void);
+Four EduOM_FlushDirtyPages(Four, Four*);
+Four EduOM_GetClustering(ObjectID[], Four, EduOM_Clustering*);
+Four EduOM_ReorganizeFile(ObjectID*, Four, Pool*, DeallocListElem*, EduOM_ReorgResult*);
+Four EduOM_CollapseForwarding(ObjectID*, PageNo*, Four, Four*);
 
 Four OM_DumpObject(ObjectID *);
 
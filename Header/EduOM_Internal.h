@@ -26,6 +26,9 @@
 #define _EDUOM_INTERNAL_H_
 
 
+#include "Util_pool.h"
+
+
 /*@
  * Type Definitions
  */
@@ -75,6 +78,79 @@ typedef struct {
 } SlottedPage;
 
 
+/*
+ * Typedef for the counters of the EduOM operations
+ */
+typedef struct {
+	Four nInsert;           /* # of objects inserted into pages */
+	Four nCompactPage;      /* # of pages compacted */
+	Four nPagesFlushed;     /* # of pages written by EduOM_FlushDirtyPages() */
+	Four nDirtyQueued;      /* # of dirty pages waiting to be written (now) */
+} EduOM_Statistics;
+
+/*
+ * Typedef for the clustering of a sequence of objects
+ */
+typedef struct {
+	Four nPairs;            /* # of pairs of adjacent objects */
+	Four nSamePage;         /* # of pairs stored in the same page */
+	Four nSameExtent;       /* # of pairs stored in the same extent */
+	Four sumExtDistance;    /* sum of the extent distances of the pairs */
+	Four maxExtDistance;    /* largest extent distance of a pair */
+} EduOM_Clustering;
+
+/*
+ * Typedef for the result of EduOM_ReorganizeFile()
+ */
+typedef struct {
+	Four nPagesBefore;      /* # of pages in the page list before */
+	Four nPagesAfter;       /* # of pages in the page list after */
+	Four nPagesFreed;       /* # of pages deallocated */
+	Four nPagesUnlinked;    /* # of pages left holding only stubs */
+	Four nObjectsMoved;     /* # of objects moved to other pages */
+} EduOM_ReorgResult;
+
+/*
+ * Typedef for the handle of an object pinned by EduOM_PinObject()
+ */
+typedef struct {
+	PageID pid;             /* page kept fixed while the object is pinned */
+	Boolean pinned;         /* TRUE until EduOM_UnpinObject() is called */
+} PinHandle;
+
+/*
+ * Typedef for the cursor of a sequential scan by EduOM_ScanNext()
+ */
+typedef struct {
+	PageID pid;             /* current page, fixed while the scan is open */
+	SlottedPage *apage;     /* pointer to the buffer of the current page */
+	Two slotNo;             /* slot returned last, NIL before the first one */
+	Boolean open;           /* TRUE from the open until EduOM_CloseScan() */
+	Boolean pinned;         /* TRUE if the current page is fixed */
+	Boolean evict;          /* TRUE if the pages brought in are evicted first */
+	Boolean ownPage;        /* TRUE if the scan brought in the current page */
+} ScanCursor;
+
+/*
+ * Typedef for the handle of a bulk load by EduOM_NextBulkLoad()
+ */
+#define EDUOM_BLKLD_NPAGES 64   /* # of page images built before written */
+
+typedef struct {
+	ObjectID catObjForFile; /* file being loaded */
+	Four fillFactor;        /* % of the data area of a page to be filled */
+	char *buf;              /* images of the pages being built */
+	PageID pids[EDUOM_BLKLD_NPAGES]; /* pages allocated for the images */
+	Four nAllocated;        /* # of pages allocated in pids[] */
+	Four nImages;           /* # of images built in buf */
+	PageID prevPid;         /* page preceding the current image in the file */
+	ShortPageID oldLastPage;        /* last page of the file before the load */
+	ShortPageID firstPage;          /* first page loaded */
+	ShortPageID listNewest[5];      /* newest page loaded in each available */
+	ShortPageID listOldest[5];      /*   space list and the oldest one */
+} BulkLoadHandle;
+
+
 /*@
  * Macro Function Definitions
  */
@@ -119,6 +195,99 @@ typedef struct {
 	(((s_page->slot[-(oid)->slotNo].offset == EMPTYSLOT) || \
 	  (s_page->slot[-(oid)->slotNo].unique != (oid)->unique)) ? FALSE : TRUE)
 
+/*
+ * The empty slots of a page are chained in the ascending order of the slot
+ * number through their 'unique' field; the 'offset' field keeps EMPTYSLOT.
+ * The head of the chain is kept in the low half of the 'reserved' field of
+ * the page header and the high half holds SP_FREESLOT_MAGIC when the chain
+ * is valid. Pages without the magic are of the old format.
+ */
+#define SP_FREESLOT_MAGIC   0x46530000
+#define SP_FREESLOT_MASK    0xffff0000
+
+/* Macro: SP_HAS_FREESLOTLIST(p)
+ * Description: check whether the page given as a parameter keeps the free slot list
+ * Parameter:
+ *  SlottedPage *p      : pointer to the page
+ * Returns: TRUE(1) if the free slot list is valid, otherwise FALSE(0)
+ */
+#define SP_HAS_FREESLOTLIST(p) \
+	((((p)->header.reserved & SP_FREESLOT_MASK) == SP_FREESLOT_MAGIC) ? TRUE : FALSE)
+
+/* Macro: SP_FREESLOT_HEAD(p)
+ * Description: return the first empty slot of the page given as a parameter
+ * Parameter:
+ *  SlottedPage *p      : pointer to the page
+ * Returns: (Two) slot number of the first empty slot or NIL
+ */
+#define SP_FREESLOT_HEAD(p)     ((Two)((p)->header.reserved & 0xffff))
+
+/* Macro: SET_SP_FREESLOT_HEAD(p, s)
+ * Description: set the first empty slot of the page given as a parameter
+ * Parameters:
+ *  SlottedPage *p      : (OUT) pointer to the page
+ *  Two s               : slot number of the first empty slot or NIL
+ */
+#define SET_SP_FREESLOT_HEAD(p, s) \
+	((p)->header.reserved = SP_FREESLOT_MAGIC | ((s) & 0xffff))
+
+/* Macro: SP_NEXT_FREESLOT(p, s)
+ * Description: access the link to the next empty slot of the empty slot 's'
+ * Parameters:
+ *  SlottedPage *p      : pointer to the page
+ *  Two s               : slot number of an empty slot
+ */
+#define SP_NEXT_FREESLOT(p, s)  ((p)->slot[-(s)].unique)
+
+/*
+ * An object moved to another page leaves a forwarding stub in its original
+ * slot so that its ObjectID stays valid. The stub has P_MOVED set and its
+ * data is the ObjectID of the forwarded record. The forwarded record has
+ * P_FORWARDED set and keeps the ObjectID of the stub in front of the data,
+ * so that a scan visiting the forwarded record can return the original
+ * ObjectID. A page which holds only stubs is taken out of the page list of
+ * the file and is marked with SP_STUBPAGE in the 'flags' field.
+ */
+#define SP_STUBPAGE         0x100
+#define FWD_BACKPTR_LEN     ((Four)sizeof(ObjectID))
+
+/* Macro: OBJ_DATA(obj)
+ * Description: return the start of the user data of an object
+ * Parameter:
+ *  Object *obj         : pointer to the object in the page
+ */
+#define OBJ_DATA(obj) \
+	(((obj)->header.properties & P_FORWARDED) ? &((obj)->data[FWD_BACKPTR_LEN]) : (obj)->data)
+
+/* Macro: OBJ_LENGTH(obj)
+ * Description: return the length of the user data of an object
+ * Parameter:
+ *  Object *obj         : pointer to the object in the page
+ */
+#define OBJ_LENGTH(obj) \
+	(((obj)->header.properties & P_FORWARDED) ? (obj)->header.length - FWD_BACKPTR_LEN : (obj)->header.length)
+
+/*
+ * A large object has P_LRGOBJ set and keeps its data in a large object tree
+ * managed by LOT. Its record holds the root of the tree, or the PageID of
+ * the root when the root does not fit in the page, and 'header.length' is
+ * the length of the whole object. A large object is never moved to another
+ * page; the record of an object converted into a large object must hold at
+ * least LRGOBJ_MIN_LENGTH bytes.
+ */
+#define LRGOBJ_MIN_LENGTH   ((Four)sizeof(ShortPageID))
+
+/* Macro: OBJ_RECORD_SIZE(obj)
+ * Description: return the # of bytes the record of an object takes in the
+ *              data area of the page, including the object header
+ *              (the caller must include LOT.h)
+ * Parameter:
+ *  Object *obj         : pointer to the object in the page
+ */
+#define OBJ_RECORD_SIZE(obj) \
+	(((obj)->header.properties & P_LRGOBJ) ? LOT_GetLengthWithHdr(obj) : \
+	 (Four)(sizeof(ObjectHdr) + ALIGNED_LENGTH((obj)->header.length)))
+
 #define LRGOBJ_THRESHOLD (PAGESIZE - SP_FIXED - sizeof(ObjectHdr))
 
 /* Macro: GET_PTR_TO_CATENTRY_FOR_DATA(catObjForFile, catPage, catEntry)
@@ -136,11 +305,54 @@ typedef struct {
 }
 
 
+/*@
+ * Global Variables
+ */
+extern EduOM_Statistics eduom_stat;     /* counters of the EduOM operations */
+extern Four eduom_nPins;                /* # of pins not yet released */
+extern Four eduom_nDirtyQueued;         /* # of dirty pages queued for write behind */
+extern Pool dlPool;                     /* pool of dealloc list elements of the system */
+
+
 /*@
  * Function Prototypes
  */
 /* internal function prototypes */
 Four eduom_CreateObject(ObjectID*, ObjectID*, ObjectHdr*, Four, char*, ObjectID*);
+Four eduom_GetPageForInsert(ObjectID*, ObjectID*, Four, PageID*, SlottedPage**);
+Four eduom_AllocPageAfter(ObjectID*, PageID*, PageID*, SlottedPage**);
+Four eduom_InitSlottedPage(SlottedPage*, PageID*, FileID*);
+Four eduom_GetUnique(SlottedPage*, Unique*);
+Four eduom_InsertInPage(SlottedPage*, ObjectHdr*, Four, char*, ObjectID*);
+Four eduom_GetFreeSlot(SlottedPage*, Two*);
+Four eduom_PutFreeSlot(SlottedPage*, Two);
+Four eduom_RebuildFreeSlotList(SlottedPage*);
+Four eduom_GetCatalogEntry(ObjectID*, sm_CatOverlayForData**);
+Four eduom_WriteCatalogEntry(ObjectID*, sm_CatOverlayForData*);
+Four eduom_RefreshCatalogEntry(ObjectID*, sm_CatOverlayForData*);
+Four eduom_PutInAvailSpaceList(ObjectID*, PageID*, SlottedPage*);
+Four eduom_RemoveFromAvailSpaceList(ObjectID*, PageID*, SlottedPage*, Four);
+Four eduom_UpdateAvailSpaceList(ObjectID*, PageID*, SlottedPage*, Four);
+Four eduom_FindPageInFreeSpaceMap(ObjectID*, Four, PageNo*);
+Four eduom_FindPageInFreeSpaceMapRange(ObjectID*, Four, PageNo, Four, PageNo*);
+Four eduom_SetFreeSpaceMap(ObjectID*, PageID*, Four);
+Four eduom_ClearFreeSpaceMap(ObjectID*, PageID*);
+void eduom_DropFreeSpaceMap(ObjectID*);
+Four eduom_AllocPage(ObjectID*, PageID*, PageID*);
+void eduom_BeginPreallocation(ObjectID*);
+Four eduom_EndPreallocation(ObjectID*);
+void eduom_DropPreallocatedPages(ObjectID*);
+Four eduom_FollowForwarding(ObjectID*, PageID*, SlottedPage**, ObjectID*);
+Four eduom_FixObject(ObjectID*, PageID*, SlottedPage**, Object**, ObjectID*);
+void eduom_GetLogicalObject(SlottedPage*, Two, ObjectID*, ObjectHdr*);
+Four eduom_RelocateObject(PageID*, SlottedPage*, Two, SlottedPage*, ObjectID*);
+Four eduom_RetargetStub(ObjectID*, ObjectID*);
+Four eduom_ResizeInPage(SlottedPage*, Two, Four);
+Four eduom_RemoveFromPage(SlottedPage*, Two);
+Four eduom_SetDirty(PageID*, Four);
+#ifdef EDUOM_PIN_DEBUG
+Boolean eduom_IsPinnedPage(PageID*);
+#endif
 
 Four om_FileMapAddPage(ObjectID*, PageID*, PageID*);
 Four om_FileMapDeletePage(ObjectID*, PageID*);
@@ -148,6 +360,11 @@ Four om_GetUnique(PageID*, Unique*);
 Four om_IsTemporary(FileID*, Boolean*);
 Four om_PutInAvailSpaceList(ObjectID*, PageID*, SlottedPage*);
 Four om_RemoveFromAvailSpaceList(ObjectID*, PageID*, SlottedPage*);
+Four LOT_ConvertToLarge(ObjectID*, SlottedPage*, Two, Pool*, DeallocListElem*);
+
+/* internal routines of the buffer manager in cosmos.o, not part of BfM.h */
+Four bfm_LookUp(TrainID*, Four);
+Four bfm_FlushTrain(TrainID*, Four);
 
     
 #endif /* _EDUOM_INTERNAL_H_ */
@@ -35,6 +35,7 @@
 /* Size in PAGESIZE */
 #define PAGESIZE    4096      /* NOTE: PAGESIZE must be a multiple of read/write buffer align size */
 #define PAGESIZE2	1		  /* The number of page to be allocated and free */
+#define TRAINSIZE2	4		  /* The number of pages in a train of a large object */
 
 
 #define BEGIN_MACRO do {
@@ -334,6 +335,8 @@ typedef struct _DeallocListElem DeallocListElem;
  */
 #undef MAX
 #define MAX(a,b) (((a) >= (b)) ? (a):(b))
+#undef MIN
+#define MIN(a,b) (((a) <= (b)) ? (a):(b))
 
 
 /*
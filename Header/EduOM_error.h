@@ -50,6 +50,14 @@ END_MACRO
     if (1) return(e); \
 END_MACRO
 
+#define ERRB2(e, pid1, t1, pid2, t2) \
+	BEGIN_MACRO \
+    PRTERR(e); \
+    (Four) BfM_FreeTrain((pid1),(t1)); \
+    (Four) BfM_FreeTrain((pid2),(t2)); \
+    if (1) return(e); \
+END_MACRO
+
 /*
  * Function Prototypes
  */
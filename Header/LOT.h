@@ -28,6 +28,7 @@
 #include "Util_pool.h"
 
 
+Four LOT_AppendToObject(ObjectID*, PageID*, Two, Four, char*);
 Four LOT_DestroyObject(PageID*, Two, Pool*, DeallocListElem*);
 Four LOT_GetLengthWithHdr(Object*);
 Four LOT_ReadObject(PageID*, Two, Four, Four, char*);
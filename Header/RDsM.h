@@ -29,6 +29,10 @@
 Four    RDsM_AllocTrains(Four, Four, PageID *, Two, Four, Two, PageID *);
 Four    RDsM_GetUnique(PageID*, Unique*, Four*);
 Four	RDsM_PageIdToExtNo(PageID *, Four *);
+Four    RDsM_WriteTrains(char *, PageID *, Four, Two);
+Four    RDsM_FreeTrain(PageID *, Two);
+Four    RDsM_GetSizeOfExt(Four, Two *);
+Four    RDsM_ExtNoToPageId(Four, Four, PageID *);
 
 
 #endif /* _RDsM_H_ */